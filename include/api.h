@@ -5,6 +5,7 @@
 #include <HTTPClient.h>
 #include <ArduinoJson.h>
 #include <WiFi.h>
+#include <functional>
 
 // API Configuration
 #define MANGA_API_BASE_URL "https://mangahook-api.vercel.app"
@@ -38,6 +39,7 @@ struct MangaMetadata
     String categories[40];
 };
 
+// Lists beyond the array sizes are counted but not stored
 struct MangaDetail
 {
     String id;
@@ -48,8 +50,9 @@ struct MangaDetail
     String status;
     String lastUpdate;
     int totalChapters;
+    int genreCount;
     String genres[20];
-    String chapters[100]; // Chapter list
+    String chapters[100]; // Chapter ids, as listed by the site (newest first)
 };
 
 struct ChapterData
@@ -67,21 +70,32 @@ struct APIResponse
 {
     bool success;
     int statusCode;
-    String data;
+    String data; // Body, only kept by the buffered makeAPIRequest
     String error;
 };
 
+// Reads the body of a successful response; returns false if it cannot be parsed
+typedef std::function<bool(Stream &body)> APIBodyHandler;
+
 // API function declarations
+// GET endpoint?params; the body is handed to handler straight from the socket
+APIResponse makeAPIRequest(const String &endpoint, const String &params, const APIBodyHandler &handler);
+// Same, with the body buffered in APIResponse::data; only for small responses
 APIResponse makeAPIRequest(const String &endpoint, const String &params = "");
-APIResponse getMangaList(int page = 1, const String &category = "", const String &status = "");
-APIResponse getMangaDetail(const String &mangaId);
-APIResponse searchManga(const String &query, int page = 1);
-APIResponse getChapterData(const String &mangaId, const String &chapterId);
 
-// JSON parsing functions
-bool parseMangaList(const String &jsonData, MangaListItem *items, int &count);
-bool parseMangaDetail(const String &jsonData, MangaDetail &manga);
-bool parseChapterData(const String &jsonData, ChapterData &chapter);
+// The typed requests parse their response as it arrives, keeping only the
+// fields the structs hold; count returns the items stored, at most maxItems
+APIResponse getMangaList(MangaListItem *items, int maxItems, int &count, MangaMetadata *meta = nullptr,
+                         int page = 1, const String &category = "", const String &status = "");
+APIResponse getMangaDetail(const String &mangaId, MangaDetail &manga);
+APIResponse searchManga(const String &query, MangaListItem *items, int maxItems, int &count, int page = 1);
+APIResponse getChapterData(const String &mangaId, const String &chapterId, ChapterData &chapter);
+
+// JSON parsing functions, reading from a stream through ArduinoJson filters
+bool parseMangaList(Stream &input, MangaListItem *items, int maxItems, int &count, MangaMetadata *meta = nullptr);
+bool parseMangaDetail(Stream &input, MangaDetail &manga);
+// chapter.id, when set, places the chapter in the list for next/prev
+bool parseChapterData(Stream &input, ChapterData &chapter);
 
 // Network utility functions
 bool isNetworkConnected();
@@ -103,7 +117,8 @@ void initHTTP();
  * 2. GET /api/manga/{id}
  *    - Returns detailed manga information
  *    - Parameters: manga ID
- *    - Response: JSON with manga details, chapters, etc.
+ *    - Response: JSON with name, imageUrl, author, status, updated,
+ *      genres and a chapterList of {id, name}
  *
  * 3. GET /api/search
  *    - Search manga by title
@@ -113,7 +128,8 @@ void initHTTP();
  * 4. GET /api/chapter/{mangaId}/{chapterId}
  *    - Returns chapter images and navigation
  *    - Parameters: manga ID, chapter ID
- *    - Response: JSON with image URLs and navigation
+ *    - Response: JSON with title, images of {title, image} and the
+ *      manga's chapterListIds of {id, name}
  *
  * Example Response Format:
  * {
@@ -1,6 +1,7 @@
 #ifndef DISPLAY_H
 #define DISPLAY_H
 
+#include <Adafruit_GFX.h>
 #include <GxEPD2_BW.h>
 #include <Fonts/FreeMono9pt7b.h>
 #include <Fonts/FreeMono12pt7b.h>
@@ -8,7 +9,101 @@
 #include <Fonts/FreeMonoBold9pt7b.h>
 #include <Fonts/FreeMonoBold12pt7b.h>
 #include <Fonts/FreeMonoBold18pt7b.h>
+#include <vector>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
 #include "pins.h"
+#include "refresh_metrics.h"
+
+// Rectangle in the panel's native coordinates
+struct DirtyRect
+{
+    int16_t x;
+    int16_t y;
+    int16_t w;
+    int16_t h;
+};
+
+// 1bpp drawing surface in the panel's native layout: rows of packed bits,
+// MSB first, 1 = white. Frames can trade pixel storage in O(1), which lets
+// screens be drawn off-screen with the usual GFX calls and shown later.
+class FrameBuffer final : public GFXcanvas1
+{
+public:
+    FrameBuffer(uint16_t w, uint16_t h);
+
+    bool isAllocated() const { return buffer != nullptr; }
+    uint8_t *data() { return buffer; }
+    const uint8_t *data() const { return buffer; }
+    size_t byteSize() const { return ((WIDTH + 7) / 8) * HEIGHT; }
+
+    // Unrotated geometry, the layout of data()
+    int16_t rawWidth() const { return WIDTH; }
+    int16_t rawHeight() const { return HEIGHT; }
+
+    // Exchange pixel storage with a frame of the same size
+    void swap(FrameBuffer &other);
+
+    // Drawing primitives, each also records the rows and columns it touched
+    void drawPixel(int16_t x, int16_t y, uint16_t color) override;
+    void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) override;
+    void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) override;
+    void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) override;
+    void fillScreen(uint16_t color) override;
+
+    // Dirty tracking: per raw row, the span of columns drawn since the last clear
+    void markDirty(int16_t x, int16_t y, int16_t w, int16_t h);
+    void markAllDirty();
+    void clearDirty();
+    bool isDirty() const { return m_dirtyTop <= m_dirtyBottom; }
+    int16_t dirtyTop() const { return m_dirtyTop; }
+    int16_t dirtyBottom() const { return m_dirtyBottom; }
+
+    // Dirty columns of a raw row, false when the row is clean
+    bool dirtySpan(int16_t row, int16_t &minX, int16_t &maxX) const
+    {
+        if (row < 0 || row >= HEIGHT || m_dirtyMaxX[row] < 0)
+            return false;
+        minX = m_dirtyMinX[row];
+        maxX = m_dirtyMaxX[row];
+        return true;
+    }
+
+    // Narrow the dirty rows to the bytes that differ from previous, a frame of
+    // the same layout, comparing 32 bits at a time. Returns the changed pixels
+    uint32_t narrowDirty(const uint8_t *previous);
+
+    // Group dirty rows into at most maxRects bands, rows closer than mergeGap
+    // share a band. Returns the number of rects written to out
+    int dirtyRects(DirtyRect *out, int maxRects, int mergeGap) const;
+
+private:
+    void markRaw(int16_t x0, int16_t y0, int16_t x1, int16_t y1);
+    void markByte(size_t index);
+
+    std::vector<int16_t> m_dirtyMinX;
+    std::vector<int16_t> m_dirtyMaxX;
+    int16_t m_dirtyTop;
+    int16_t m_dirtyBottom;
+};
+
+// GDEY037T03 driver with the UC8253's fast refresh.
+// The controller chooses its OTP waveform by temperature; forcing the
+// reading the panel vendor specifies selects the short full-refresh
+// waveform. Its timings are in the KIND_FAST refresh metrics.
+class GDEY037T03Panel final : public GxEPD2_370_GDEY037T03
+{
+public:
+    static const uint8_t FAST_TEMPERATURE = 0x5A;
+    static const uint16_t FAST_REFRESH_TIME = 1500;
+
+    GDEY037T03Panel(int16_t cs, int16_t dc, int16_t rst, int16_t busy) : GxEPD2_370_GDEY037T03(cs, dc, rst, busy) {}
+
+    // Full-panel refresh of the written image with the fast waveform
+    void refreshFast();
+};
 
 class EinkDisplayManager
 {
@@ -20,6 +115,7 @@ public:
     void sleep();
     void wake();
     void startDrawing();
+    void startDrawing(int16_t x, int16_t y, int16_t w, int16_t h); // Clear only this region
     void endDrawing();
 
     enum DisplayUpdateMode
@@ -28,32 +124,154 @@ public:
         UPDATE_PARTIAL,
         UPDATE_FAST
     };
+    // Starts the refresh and returns; it completes on the display task
+    // UPDATE_FAST is a full-panel refresh with the short waveform, for whole
+    // screen changes such as list pages and chapter jumps. Page turns stay
+    // partial: they refresh only the changed windows
     void update(DisplayUpdateMode mode = UPDATE_PARTIAL);
 
-    // --- Public access to the display object and helpers ---
-    GxEPD2_BW<GxEPD2_370_GDEY037T03, GxEPD2_370_GDEY037T03::HEIGHT> m_display;
+    // Block until the panel has finished the refresh in progress, if any
+    void waitForRefresh();
+    bool isRefreshing() const;
+
+    // Layers are retained regions painted over the screen content by
+    // endDrawing(); each can be repainted and refreshed on its own
+    enum DisplayLayer
+    {
+        LAYER_STATUS_BAR,
+        LAYER_COUNT
+    };
+    typedef void (*LayerPainter)();
+    void setLayer(DisplayLayer layer, int16_t x, int16_t y, int16_t w, int16_t h, LayerPainter paint);
+
+    // Repaint one layer over the shown frame and refresh only its region
+    void refreshLayer(DisplayLayer layer, DisplayUpdateMode mode = UPDATE_PARTIAL);
+
+    // Off-screen frame with the panel's geometry, or null when out of memory
+    FrameBuffer *createFrame();
+
+    // Refresh counters: the last update and running totals
+    struct RefreshStats
+    {
+        uint32_t updates;
+        uint32_t skipped;     // Partial updates that changed no pixel
+        uint32_t lastBytes;   // Frame bytes sent for the refreshed windows
+        uint32_t lastPixels;  // Pixels that differ from the frame shown before
+        uint32_t lastWindows; // 0 when the whole panel was sent
+        uint64_t totalBytes;
+        uint64_t totalPixels;
+    };
+    const RefreshStats &getStats() const { return m_stats; }
+
+    // Latency histograms per kind of refresh, kept in SPIFFS across boots;
+    // begin() loads them, so SPIFFS must be mounted first
+    RefreshMetrics &getMetrics() { return m_metrics; }
+    void saveMetrics();
+
+    // --- Public access to the frame buffer and helpers ---
+    FrameBuffer m_display;
 
     // Helper functions
     void drawCenteredText(const char *text, int y, const GFXfont *font);
     void drawBatteryIcon(int x, int y, float battery_voltage, bool charging);
     void drawWifiIcon(int x, int y, bool connected);
+
+    // Write one row of a 4-gray image given as its two bit planes (see
+    // GrayDither). The panel has black and white waveforms only, so the two
+    // middle levels are folded into the frame as 2x2 patterns; with a 4-gray
+    // waveform the planes would go to the panel's two image RAMs as they are
+    void writeGrayRow(int16_t x, int16_t y, const uint8_t *hi, const uint8_t *lo, int16_t width);
     
-    // Screen clearing function to eliminate ghosting without flicker
+    // Clear the frame and clean the ghosting of the previous screen with the
+    // next update: a partial update first drives the previously-black pixels
+    // white in one region-limited pass, a full or fast one needs nothing more
     void wipeScreen();
-    
-    // Reset partial update counter (useful during active navigation)
-    void resetPartialUpdateCount();
 
 private:
+    // Windowed partial refresh limits
+    static const int MAX_DIRTY_WINDOWS = 4;
+    static const int DIRTY_MERGE_GAP = 16;     // Rows between bands worth one extra window
+    static const int DIRTY_FULL_PERCENT = 60;  // Above this share of the panel send the whole frame
+
+    // One panel refresh as handed to the display task
+    struct RefreshJob
+    {
+        RefreshMetrics::Kind kind;
+        unsigned long startedUs; // When update() was called
+        bool partial;
+        bool fast; // Full-panel refresh with the fast waveform
+        int count; // Windows to send, 0 for the whole frame
+        DirtyRect windows[MAX_DIRTY_WINDOWS];
+        DirtyRect area; // Refreshed region, the bounding box of the windows
+        bool clean;     // Ghost cleanup of cleanArea after the refresh
+        DirtyRect cleanArea;
+        bool wipe; // Drive wipeArea white before the refresh
+        DirtyRect wipeArea;
+    };
+
+    // Display task; BUSY_N is held low by the UC8253 while a waveform runs
+    static const BaseType_t TASK_CORE = 0;
+    static const UBaseType_t TASK_PRIORITY = 2;
+    static const uint32_t TASK_STACK_SIZE = 4096;
+    static const int BUSY_LEVEL = LOW;
+    static const uint32_t BUSY_POLL_MS = 20;
+
+    static const unsigned long METRICS_SAVE_INTERVAL = 10 * 60 * 1000;
+
+    void planFrame(RefreshJob &job, bool partial_update);
+    bool planWindows(RefreshJob &job);
+    bool planCleanup(DirtyRect &area);
+    bool planWipe(DirtyRect &area);
+    void rememberShown(int16_t top, int16_t bottom);
+    void accountGhosting();
+    void paintLayer(DisplayLayer layer);
+    void submit(const RefreshJob &job);
+    void loadMetrics();
+    void runJob(const RefreshJob &job, const uint8_t *frame);
+
+    static void taskEntry(void *param);
+    static void busyCallback(const void *param);
+    static void busyInterrupt();
+
+    // Ghosting model: each tile counts the partial refreshes that changed it
+    // and is cleaned once it has taken GHOST_BUDGET of them
+    static const int GHOST_TILE = 32;
+    static const int GHOST_COLS = (GxEPD2_370_GDEY037T03::WIDTH + GHOST_TILE - 1) / GHOST_TILE;
+    static const int GHOST_ROWS = (GxEPD2_370_GDEY037T03::HEIGHT + GHOST_TILE - 1) / GHOST_TILE;
+    static const uint8_t GHOST_BUDGET = 10;
+    static const uint8_t GHOST_AFTER_FAST = GHOST_BUDGET / 2; // The fast waveform leaves some residue
+
+    GDEY037T03Panel m_epd;
+
     struct DisplayState
     {
         bool initialized;
         bool sleeping;
         bool dirty;
         unsigned long last_full_refresh;
-        int partial_update_count;
     };
     DisplayState m_state;
+    uint8_t m_ghost[GHOST_ROWS][GHOST_COLS];
+
+    struct LayerState
+    {
+        DirtyRect rect; // In drawing coordinates
+        LayerPainter paint;
+    };
+    LayerState m_layers[LAYER_COUNT];
+
+    // Copy of the frame last sent to the panel, the reference for diffing
+    uint8_t *m_shown;
+    bool m_shownValid;
+    bool m_wipePending;
+    RefreshStats m_stats;
+    RefreshMetrics m_metrics;
+    unsigned long m_lastMetricsSave;
+
+    QueueHandle_t m_jobs;
+    SemaphoreHandle_t m_idle; // Given while no refresh is in flight
+    TaskHandle_t m_task;
+    static volatile TaskHandle_t s_busyWaiter;
 };
 
 #endif // DISPLAY_H
\ No newline at end of file
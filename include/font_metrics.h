@@ -0,0 +1,50 @@
+#ifndef FONT_METRICS_H
+#define FONT_METRICS_H
+
+#include <Arduino.h>
+#include <Adafruit_GFX.h>
+
+// Per-font glyph advance table.
+// Text width is the sum of glyph xAdvance values, which is exactly how far
+// Adafruit_GFX moves the cursor when printing, so measuring never needs
+// getTextBounds. The bundled FreeMono fonts are monospaced and described
+// by compile-time constants; any other GFXfont gets a table built from its
+// glyphs. Fonts are matched by metrics rather than address because every
+// translation unit including display.h holds its own copy of the fonts.
+class FontMetrics
+{
+public:
+    static const uint8_t FIRST_CHAR = 0x20;
+    static const uint8_t CHAR_COUNT = 0x5F; // 0x20..0x7E, the 7-bit GFX fonts
+
+    constexpr FontMetrics(const GFXfont *font, uint8_t fixedAdvance, uint8_t yAdvance)
+        : m_font(font), m_fixedAdvance(fixedAdvance), m_yAdvance(yAdvance), m_advance{} {}
+
+    // Metrics for a font; cheap for the bundled fonts, a glyph scan otherwise
+    static FontMetrics forFont(const GFXfont *font);
+
+    uint8_t advance(uint8_t c) const
+    {
+        if (c < FIRST_CHAR || c >= FIRST_CHAR + CHAR_COUNT)
+        {
+            return 0;
+        }
+        return m_fixedAdvance ? m_fixedAdvance : m_advance[c - FIRST_CHAR];
+    }
+
+    uint16_t measure(const char *text, size_t length) const;
+    uint16_t measure(const char *text) const { return measure(text, strlen(text)); }
+
+    const GFXfont *font() const { return m_font; }
+    uint8_t yAdvance() const { return m_yAdvance; }
+
+private:
+    void build(const GFXfont *font);
+
+    const GFXfont *m_font;
+    uint8_t m_fixedAdvance; // Non-zero for monospaced fonts
+    uint8_t m_yAdvance;
+    uint8_t m_advance[CHAR_COUNT];
+};
+
+#endif // FONT_METRICS_H
@@ -0,0 +1,47 @@
+#ifndef GLYPH_BLITTER_H
+#define GLYPH_BLITTER_H
+
+#include <Arduino.h>
+#include <Adafruit_GFX.h>
+#include <vector>
+
+// Direct 1bpp text renderer for GFXcanvas1 frames.
+// Adafruit_GFX draws text with one writePixel call per set glyph bit. The
+// blitter expands the active font once into a cache of left-aligned 32-bit
+// rows and writes each glyph row into the frame with a shift and masks, a
+// few byte operations per row instead of a call per pixel.
+class GlyphBlitter
+{
+public:
+    // A row shifted to any bit within its first byte still fits in 32 bits
+    static const uint8_t MAX_GLYPH_WIDTH = 25;
+
+    GlyphBlitter();
+
+    // Expand a font into the glyph cache; false if it cannot be cached, in
+    // which case drawText falls back to the canvas' own text drawing
+    bool setFont(const GFXfont *font);
+    const GFXfont *font() const { return m_font; }
+
+    // Draw text with its baseline at (x, y), returns the x after the last glyph
+    int16_t drawText(GFXcanvas1 &canvas, int16_t x, int16_t y, const char *text, size_t length, uint16_t color);
+
+private:
+    struct CachedGlyph
+    {
+        uint16_t row; // First row in m_rows
+        uint8_t height;
+        uint8_t xAdvance;
+        int8_t xOffset;
+        int8_t yOffset;
+    };
+
+    const GFXfont *m_font;
+    bool m_cached;
+    uint16_t m_first;
+    uint16_t m_last;
+    std::vector<CachedGlyph> m_glyphs;
+    std::vector<uint32_t> m_rows;
+};
+
+#endif // GLYPH_BLITTER_H
@@ -0,0 +1,52 @@
+#ifndef GRAY_DITHER_H
+#define GRAY_DITHER_H
+
+#include <Arduino.h>
+#include <vector>
+
+// Row-by-row dithering of 8-bit gray to the panel's 1bpp, or to four gray
+// levels split into two bit planes as a 4-gray waveform takes them.
+// Rows are fed top to bottom, so an image is never held whole: the ordered
+// kernel needs no state at all and error diffusion keeps the error of just
+// the current and the next row.
+class GrayDither
+{
+public:
+    enum Kernel
+    {
+        KERNEL_ORDERED,   // 4x4 Bayer thresholds: fast, regular pattern
+        KERNEL_DIFFUSION, // Floyd-Steinberg, serpentine: finer tones, more work per pixel
+    };
+
+    GrayDither();
+
+    // Prepare for an image width pixels wide dithered to levels (2 or 4)
+    // shades, resets the row count
+    bool begin(uint16_t width, Kernel kernel, uint8_t levels = 2);
+    void end();
+
+    Kernel kernel() const { return m_kernel; }
+    uint8_t levels() const { return m_levels; }
+    static const char *kernelName(Kernel kernel);
+
+    // Dither the next row of gray (0 black .. 255 white) into packed bits,
+    // MSB first, 1 = white; bits holds (width + 7) / 8 bytes
+    void ditherRow(const uint8_t *gray, uint8_t *bits);
+
+    // Dither the next row to four levels, 0 black .. 3 white, as two planes
+    // of packed bits laid out like the 1bpp row: hi holds bit 1 of each
+    // pixel's level and lo bit 0
+    void ditherRow(const uint8_t *gray, uint8_t *hi, uint8_t *lo);
+
+private:
+    void orderedRow(const uint8_t *gray, uint8_t *hi, uint8_t *lo);
+    void diffusionRow(const uint8_t *gray, uint8_t *hi, uint8_t *lo);
+
+    uint16_t m_width;
+    uint16_t m_row;
+    Kernel m_kernel;
+    uint8_t m_levels;
+    std::vector<int16_t> m_error; // Two rows of width + 2, one guard column each side
+};
+
+#endif // GRAY_DITHER_H
@@ -0,0 +1,78 @@
+#ifndef REFRESH_METRICS_H
+#define REFRESH_METRICS_H
+
+#include <Arduino.h>
+#include <FS.h>
+#include <freertos/FreeRTOS.h>
+
+// Fixed-bucket latency histogram, in milliseconds
+struct LatencyHistogram
+{
+    static const int BUCKETS = 12;
+    static const uint16_t BOUNDS_MS[BUCKETS - 1]; // Upper bounds, the last bucket is open
+
+    uint32_t counts[BUCKETS];
+    uint32_t count;
+    uint32_t maxMs;
+    uint64_t totalMs;
+
+    void record(uint32_t ms);
+
+    // Upper bound of the bucket holding the given percentile
+    uint32_t percentile(int percent) const;
+};
+
+// Where the time of each panel refresh goes, per kind of refresh: SPI
+// transfer, waiting on BUSY, and the whole update from the update() call
+// to the end of the waveform. Recorded on the display task, read and
+// persisted from the loop.
+class RefreshMetrics
+{
+public:
+    enum Kind
+    {
+        KIND_FULL,
+        KIND_PARTIAL,
+        KIND_FAST,
+        KIND_CLEANUP, // Ghost cleanup of stale tiles
+        KIND_WIPE,    // Pass clearing the previous screen after wipeScreen()
+        KIND_COUNT
+    };
+
+    static const uint32_t FILE_MAGIC = 0x41545352; // "RSTA"
+    static const uint16_t FILE_VERSION = 1;
+
+    RefreshMetrics();
+
+    void record(Kind kind, uint32_t spiMs, uint32_t busyMs, uint32_t totalMs);
+    void reset();
+
+    void print(Print &out);
+
+    // Totals carry over across boots through a small file
+    bool load(fs::FS &fs, const char *path);
+    bool save(fs::FS &fs, const char *path);
+
+private:
+    struct Entry
+    {
+        LatencyHistogram spi;
+        LatencyHistogram busy;
+        LatencyHistogram total;
+    };
+
+    struct FileHeader
+    {
+        uint32_t magic;
+        uint16_t version;
+        uint8_t kinds;
+        uint8_t buckets;
+    };
+
+    void snapshot(Entry *out);
+
+    Entry m_entries[KIND_COUNT];
+    portMUX_TYPE m_lock;
+};
+
+#endif // REFRESH_METRICS_H
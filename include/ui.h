@@ -27,6 +27,12 @@ void initializeUI();
  */
 void updateUI();
 
+/**
+ * @brief Writes state that is saved lazily, such as the reading position.
+ * Must be called before deep sleep.
+ */
+void saveUIState();
+
 /**
  * @brief Handles button presses for UI navigation.
  * @param button The button that was pressed (1, 2, or 3).
@@ -0,0 +1,295 @@
+#include "api.h"
+#include <WiFiClientSecure.h>
+
+// The API is public and read-only; its certificate is not pinned
+static WiFiClientSecure s_client;
+static bool s_httpReady = false;
+
+bool isNetworkConnected()
+{
+    return WiFi.status() == WL_CONNECTED;
+}
+
+String urlEncode(const String &str)
+{
+    static const char hex[] = "0123456789ABCDEF";
+    String encoded;
+    encoded.reserve(str.length() * 3);
+    for (size_t i = 0; i < str.length(); i++)
+    {
+        char c = str[i];
+        if (isalnum((unsigned char)c) || c == '-' || c == '_' || c == '.' || c == '~')
+        {
+            encoded += c;
+        }
+        else
+        {
+            encoded += '%';
+            encoded += hex[(c >> 4) & 0x0F];
+            encoded += hex[c & 0x0F];
+        }
+    }
+    return encoded;
+}
+
+void initHTTP()
+{
+    if (s_httpReady)
+        return;
+    s_client.setInsecure();
+    s_client.setTimeout(API_TIMEOUT_MS / 1000);
+    s_httpReady = true;
+}
+
+APIResponse makeAPIRequest(const String &endpoint, const String &params, const APIBodyHandler &handler)
+{
+    APIResponse response = {false, 0, "", ""};
+    if (!isNetworkConnected())
+    {
+        response.error = "WiFi not connected";
+        return response;
+    }
+    initHTTP();
+
+    String url = String(MANGA_API_BASE_URL) + endpoint;
+    if (params.length() > 0)
+    {
+        url += "?" + params;
+    }
+
+    for (int attempt = 1; attempt <= MAX_RETRIES; attempt++)
+    {
+        HTTPClient http;
+        // HTTP/1.0 rules out chunked transfer encoding, so the body can be
+        // parsed straight off the socket
+        http.useHTTP10(true);
+        http.setTimeout(API_TIMEOUT_MS);
+        if (!http.begin(s_client, url))
+        {
+            response.error = "Invalid URL";
+            return response;
+        }
+
+        response.statusCode = http.GET();
+        if (response.statusCode == HTTP_CODE_OK)
+        {
+            response.success = handler(http.getStream());
+            if (!response.success)
+            {
+                response.error = "Invalid response";
+            }
+            http.end();
+            return response;
+        }
+
+        response.error = response.statusCode < 0 ? http.errorToString(response.statusCode) : "HTTP " + String(response.statusCode);
+        http.end();
+        Serial.println("[API] " + url + " failed: " + response.error + " (attempt " + String(attempt) + ")");
+
+        // A client error will not go away on retry
+        if (response.statusCode >= 400 && response.statusCode < 500)
+            break;
+        delay(500 * attempt);
+    }
+    return response;
+}
+
+APIResponse makeAPIRequest(const String &endpoint, const String &params)
+{
+    String body;
+    APIResponse response = makeAPIRequest(endpoint, params, [&body](Stream &stream)
+                                          {
+                                              body = stream.readString();
+                                              return true; });
+    response.data = body;
+    return response;
+}
+
+APIResponse getMangaList(MangaListItem *items, int maxItems, int &count, MangaMetadata *meta,
+                         int page, const String &category, const String &status)
+{
+    String params = "page=" + String(page);
+    if (category.length() > 0)
+    {
+        params += "&category=" + urlEncode(category);
+    }
+    if (status.length() > 0)
+    {
+        params += "&status=" + urlEncode(status);
+    }
+
+    count = 0;
+    return makeAPIRequest(ENDPOINT_MANGA_LIST, params, [&](Stream &body)
+                          { return parseMangaList(body, items, maxItems, count, meta); });
+}
+
+APIResponse getMangaDetail(const String &mangaId, MangaDetail &manga)
+{
+    manga.id = mangaId;
+    return makeAPIRequest(String(ENDPOINT_MANGA_DETAIL) + "/" + urlEncode(mangaId), "", [&](Stream &body)
+                          { return parseMangaDetail(body, manga); });
+}
+
+APIResponse searchManga(const String &query, MangaListItem *items, int maxItems, int &count, int page)
+{
+    count = 0;
+    String params = "query=" + urlEncode(query) + "&page=" + String(page);
+    return makeAPIRequest(ENDPOINT_MANGA_SEARCH, params, [&](Stream &body)
+                          { return parseMangaList(body, items, maxItems, count); });
+}
+
+APIResponse getChapterData(const String &mangaId, const String &chapterId, ChapterData &chapter)
+{
+    chapter.id = chapterId;
+    String endpoint = String(ENDPOINT_MANGA_CHAPTER) + "/" + urlEncode(mangaId) + "/" + urlEncode(chapterId);
+    return makeAPIRequest(endpoint, "", [&](Stream &body)
+                          { return parseChapterData(body, chapter); });
+}
+
+// Copy up to maxCount entries of array, the key field of each or the
+// elements themselves when key is null; returns the full array size
+static int copyStrings(JsonArrayConst array, const char *key, String *out, int maxCount)
+{
+    int index = 0;
+    for (JsonVariantConst value : array)
+    {
+        if (index < maxCount)
+        {
+            out[index] = key ? (value[key] | "") : (value | "");
+        }
+        index++;
+    }
+    for (int i = index; i < maxCount; i++)
+    {
+        out[i] = "";
+    }
+    return index;
+}
+
+static bool deserializeFiltered(JsonDocument &doc, Stream &input, const JsonDocument &filter, const char *what)
+{
+    DeserializationError error = deserializeJson(doc, input, DeserializationOption::Filter(filter));
+    if (error)
+    {
+        Serial.println(String("[API] ") + what + " parse error: " + error.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool parseMangaList(Stream &input, MangaListItem *items, int maxItems, int &count, MangaMetadata *meta)
+{
+    // Only the fields MangaListItem holds are kept from each entry
+    JsonDocument filter;
+    JsonObject item = filter["mangaList"][0].to<JsonObject>();
+    item["id"] = true;
+    item["title"] = true;
+    item["image"] = true;
+    item["chapter"] = true;
+    item["view"] = true;
+    item["description"] = true;
+    if (meta)
+    {
+        JsonObject metaFilter = filter["metaData"].to<JsonObject>();
+        metaFilter["totalStories"] = true;
+        metaFilter["totalPages"] = true;
+        metaFilter["type"][0]["id"] = true;
+        metaFilter["state"][0]["id"] = true;
+        metaFilter["category"][0]["id"] = true;
+    }
+
+    count = 0;
+    JsonDocument doc;
+    if (!deserializeFiltered(doc, input, filter, "Manga list"))
+        return false;
+
+    for (JsonObjectConst entry : doc["mangaList"].as<JsonArrayConst>())
+    {
+        if (count >= maxItems)
+            break;
+        MangaListItem &out = items[count++];
+        out.id = entry["id"] | "";
+        out.title = entry["title"] | "";
+        out.image = entry["image"] | "";
+        out.chapter = entry["chapter"] | "";
+        out.view = entry["view"] | "";
+        out.description = entry["description"] | "";
+    }
+
+    if (meta)
+    {
+        JsonObjectConst metaData = doc["metaData"];
+        meta->totalStories = metaData["totalStories"] | 0;
+        meta->totalPages = metaData["totalPages"] | 0;
+        copyStrings(metaData["type"], "id", meta->types, 10);
+        copyStrings(metaData["state"], "id", meta->states, 5);
+        copyStrings(metaData["category"], "id", meta->categories, 40);
+    }
+    return true;
+}
+
+bool parseMangaDetail(Stream &input, MangaDetail &manga)
+{
+    JsonDocument filter;
+    filter["name"] = true;
+    filter["imageUrl"] = true;
+    filter["description"] = true;
+    filter["author"] = true;
+    filter["status"] = true;
+    filter["updated"] = true;
+    filter["genres"] = true;
+    filter["chapterList"][0]["id"] = true;
+
+    JsonDocument doc;
+    if (!deserializeFiltered(doc, input, filter, "Manga detail"))
+        return false;
+
+    manga.title = doc["name"] | "";
+    manga.image = doc["imageUrl"] | "";
+    manga.description = doc["description"] | "";
+    manga.author = doc["author"] | "";
+    manga.status = doc["status"] | "";
+    manga.lastUpdate = doc["updated"] | "";
+    manga.genreCount = copyStrings(doc["genres"], nullptr, manga.genres, 20);
+    manga.totalChapters = copyStrings(doc["chapterList"], "id", manga.chapters, 100);
+    return true;
+}
+
+bool parseChapterData(Stream &input, ChapterData &chapter)
+{
+    JsonDocument filter;
+    filter["title"] = true;
+    filter["images"][0]["image"] = true;
+    filter["chapterListIds"][0]["id"] = true;
+
+    JsonDocument doc;
+    if (!deserializeFiltered(doc, input, filter, "Chapter"))
+        return false;
+
+    chapter.title = doc["title"] | "";
+    chapter.totalPages = copyStrings(doc["images"], "image", chapter.images, 50);
+
+    // The chapter list runs newest first, so the next chapter comes before this one
+    chapter.nextChapter = "";
+    chapter.prevChapter = "";
+    if (chapter.id.length() == 0)
+        return true;
+    const char *previous = "";
+    bool found = false;
+    for (JsonVariantConst entry : doc["chapterListIds"].as<JsonArrayConst>())
+    {
+        const char *id = entry["id"] | "";
+        if (found)
+        {
+            chapter.prevChapter = id;
+            break;
+        }
+        if (chapter.id == id)
+        {
+            chapter.nextChapter = previous;
+            found = true;
+        }
+        previous = id;
+    }
+    return true;
+}
@@ -47,7 +47,7 @@ void button1DoubleClick() // DOWN double click
         if (bookScreen.getCurrentBookPage() < bookScreen.getTotalBookPages() - 1)
         {
             bookScreen.nextBookPage();
-            bookScreen.draw(EinkDisplayManager::UPDATE_FULL);
+            bookScreen.draw(EinkDisplayManager::UPDATE_FAST);
         }
     }
 }
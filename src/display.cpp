@@ -1,20 +1,348 @@
 #include "display.h"
 #include <Arduino.h>
+#include <SPIFFS.h>
+#include <algorithm>
+#include <utility>
 
-EinkDisplayManager::EinkDisplayManager() : m_display(GxEPD2_370_GDEY037T03(EPD_CS, EPD_DC, EPD_RST, EPD_BUSY))
+FrameBuffer::FrameBuffer(uint16_t w, uint16_t h) : GFXcanvas1(w, h),
+                                                    m_dirtyMinX(h, INT16_MAX),
+                                                    m_dirtyMaxX(h, -1),
+                                                    m_dirtyTop(INT16_MAX),
+                                                    m_dirtyBottom(-1)
 {
-    m_state = {.initialized = false, .sleeping = false, .dirty = false, .last_full_refresh = 0, .partial_update_count = 0};
+}
+
+void FrameBuffer::swap(FrameBuffer &other)
+{
+    if (WIDTH == other.WIDTH && HEIGHT == other.HEIGHT)
+    {
+        std::swap(buffer, other.buffer);
+        markAllDirty();
+        other.markAllDirty();
+    }
+}
+
+void FrameBuffer::drawPixel(int16_t x, int16_t y, uint16_t color)
+{
+    GFXcanvas1::drawPixel(x, y, color);
+    markDirty(x, y, 1, 1);
+}
+
+void FrameBuffer::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color)
+{
+    GFXcanvas1::drawFastHLine(x, y, w, color);
+    markDirty(w < 0 ? x + w + 1 : x, y, abs(w), 1);
+}
+
+void FrameBuffer::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color)
+{
+    GFXcanvas1::drawFastVLine(x, y, h, color);
+    markDirty(x, h < 0 ? y + h + 1 : y, 1, abs(h));
+}
+
+void FrameBuffer::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
+{
+    if (w < 0)
+    {
+        x += w + 1;
+        w = -w;
+    }
+    if (h < 0)
+    {
+        y += h + 1;
+        h = -h;
+    }
+
+    // Row spans are byte-filled by the canvas, and the rect is marked once
+    for (int16_t row = y; row < y + h; row++)
+    {
+        GFXcanvas1::drawFastHLine(x, row, w, color);
+    }
+    markDirty(x, y, w, h);
+}
+
+void FrameBuffer::fillScreen(uint16_t color)
+{
+    GFXcanvas1::fillScreen(color);
+    markAllDirty();
+}
+
+void FrameBuffer::markDirty(int16_t x, int16_t y, int16_t w, int16_t h)
+{
+    if (w <= 0 || h <= 0)
+        return;
+
+    // Map the rect from rotated drawing coordinates to the raw layout
+    int16_t x1 = x + w - 1;
+    int16_t y1 = y + h - 1;
+    switch (getRotation())
+    {
+    case 1:
+        markRaw(WIDTH - 1 - y1, x, WIDTH - 1 - y, x1);
+        break;
+    case 2:
+        markRaw(WIDTH - 1 - x1, HEIGHT - 1 - y1, WIDTH - 1 - x, HEIGHT - 1 - y);
+        break;
+    case 3:
+        markRaw(y, HEIGHT - 1 - x1, y1, HEIGHT - 1 - x);
+        break;
+    default:
+        markRaw(x, y, x1, y1);
+        break;
+    }
+}
+
+void FrameBuffer::markRaw(int16_t x0, int16_t y0, int16_t x1, int16_t y1)
+{
+    if (x0 < 0)
+        x0 = 0;
+    if (y0 < 0)
+        y0 = 0;
+    if (x1 >= WIDTH)
+        x1 = WIDTH - 1;
+    if (y1 >= HEIGHT)
+        y1 = HEIGHT - 1;
+    if (x0 > x1 || y0 > y1)
+        return;
+
+    for (int16_t row = y0; row <= y1; row++)
+    {
+        if (x0 < m_dirtyMinX[row])
+            m_dirtyMinX[row] = x0;
+        if (x1 > m_dirtyMaxX[row])
+            m_dirtyMaxX[row] = x1;
+    }
+    if (y0 < m_dirtyTop)
+        m_dirtyTop = y0;
+    if (y1 > m_dirtyBottom)
+        m_dirtyBottom = y1;
+}
+
+void FrameBuffer::markAllDirty()
+{
+    markRaw(0, 0, WIDTH - 1, HEIGHT - 1);
+}
+
+void FrameBuffer::clearDirty()
+{
+    for (int16_t row = m_dirtyTop; row <= m_dirtyBottom; row++)
+    {
+        m_dirtyMinX[row] = INT16_MAX;
+        m_dirtyMaxX[row] = -1;
+    }
+    m_dirtyTop = INT16_MAX;
+    m_dirtyBottom = -1;
+}
+
+uint32_t FrameBuffer::narrowDirty(const uint8_t *previous)
+{
+    if (!isDirty() || !buffer)
+        return 0;
+
+    // Only rows drawn since the last update can differ; forget their spans
+    // and mark again just the bytes whose pixels really changed
+    const size_t rowBytes = (WIDTH + 7) / 8;
+    size_t first = m_dirtyTop * rowBytes;
+    size_t end = (m_dirtyBottom + 1) * rowBytes;
+    clearDirty();
+
+    uint32_t changed = 0;
+    size_t index = first & ~(size_t)3;
+
+    // Both buffers come from malloc, so word reads are aligned
+    const uint32_t *now = reinterpret_cast<const uint32_t *>(buffer);
+    const uint32_t *before = reinterpret_cast<const uint32_t *>(previous);
+    for (; index + 4 <= end; index += 4)
+    {
+        uint32_t diff = now[index / 4] ^ before[index / 4];
+        if (diff == 0)
+            continue;
+
+        changed += __builtin_popcount(diff);
+        const uint8_t *bytes = reinterpret_cast<const uint8_t *>(&diff);
+        for (int i = 0; i < 4; i++)
+        {
+            if (bytes[i])
+                markByte(index + i);
+        }
+    }
+    for (; index < end; index++)
+    {
+        uint8_t diff = buffer[index] ^ previous[index];
+        if (diff)
+        {
+            changed += __builtin_popcount(diff);
+            markByte(index);
+        }
+    }
+    return changed;
+}
+
+void FrameBuffer::markByte(size_t index)
+{
+    const size_t rowBytes = (WIDTH + 7) / 8;
+    int16_t x = (index % rowBytes) * 8;
+    int16_t y = index / rowBytes;
+    markRaw(x, y, x + 7, y);
+}
+
+int FrameBuffer::dirtyRects(DirtyRect *out, int maxRects, int mergeGap) const
+{
+    if (maxRects <= 0)
+        return 0;
+
+    int count = 0;
+    int16_t lastRow = -1;
+
+    for (int16_t row = m_dirtyTop; row <= m_dirtyBottom; row++)
+    {
+        if (m_dirtyMaxX[row] < 0)
+            continue;
+
+        bool extend = count > 0 && row - lastRow <= mergeGap;
+        if (!extend && count == maxRects)
+        {
+            // Out of rects: join the two neighbouring bands with the smallest gap
+            int best = count - 1;
+            int bestGap = row - lastRow;
+            for (int i = 0; i + 1 < count; i++)
+            {
+                int gap = out[i + 1].y - (out[i].y + out[i].h);
+                if (gap < bestGap)
+                {
+                    best = i;
+                    bestGap = gap;
+                }
+            }
+            if (best == count - 1)
+            {
+                extend = true;
+            }
+            else
+            {
+                DirtyRect &a = out[best];
+                const DirtyRect &b = out[best + 1];
+                int16_t left = std::min(a.x, b.x);
+                int16_t right = std::max(a.x + a.w, b.x + b.w);
+                a.x = left;
+                a.w = right - left;
+                a.h = b.y + b.h - a.y;
+                for (int i = best + 1; i + 1 < count; i++)
+                {
+                    out[i] = out[i + 1];
+                }
+                count--;
+            }
+        }
+
+        if (extend)
+        {
+            DirtyRect &r = out[count - 1];
+            int16_t minX = std::min(r.x, m_dirtyMinX[row]);
+            int16_t maxX = std::max((int16_t)(r.x + r.w - 1), m_dirtyMaxX[row]);
+            r.x = minX;
+            r.w = maxX - minX + 1;
+            r.h = row - r.y + 1;
+        }
+        else
+        {
+            out[count++] = {m_dirtyMinX[row], row, (int16_t)(m_dirtyMaxX[row] - m_dirtyMinX[row] + 1), 1};
+        }
+        lastRow = row;
+    }
+    return count;
+}
+
+void GDEY037T03Panel::refreshFast()
+{
+    // Cascade setting: use the forced temperature instead of the sensor
+    _writeCommand(0xE0);
+    _writeData(0x02);
+    _writeCommand(0xE5);
+    _writeData(FAST_TEMPERATURE);
+
+    if (!_power_is_on)
+    {
+        _writeCommand(0x04);
+        _waitWhileBusy("_PowerOn", power_on_time);
+        _power_is_on = true;
+    }
+    _writeCommand(0x12);
+    _waitWhileBusy("refreshFast", FAST_REFRESH_TIME);
+
+    // Leave no forced temperature or partial-mode register behind: reset the
+    // controller and let the driver run its own init before the next write,
+    // then _Init_Full or _Init_Part as the next refresh needs. The caller
+    // rewrites the previous-image RAM right after this
+    GxEPD2_370_GDEY037T03::init(0, false, _reset_duration, _pulldown_rst_mode);
+}
+
+volatile TaskHandle_t EinkDisplayManager::s_busyWaiter = nullptr;
+
+static const char *const METRICS_PATH = "/refresh_stats.bin";
+
+// White source for the wipe pass, written over the wiped area strip by strip
+static const int WIPE_STRIP_ROWS = 16;
+static const uint8_t WIPE_STRIP[GxEPD2_370_GDEY037T03::WIDTH / 8 * WIPE_STRIP_ROWS] = {};
+
+EinkDisplayManager::EinkDisplayManager() : m_display(GxEPD2_370_GDEY037T03::WIDTH, GxEPD2_370_GDEY037T03::HEIGHT),
+                                           m_epd(EPD_CS, EPD_DC, EPD_RST, EPD_BUSY)
+{
+    m_state = {.initialized = false, .sleeping = false, .dirty = false, .last_full_refresh = 0};
+    memset(m_ghost, 0, sizeof(m_ghost));
+    m_shown = nullptr;
+    m_shownValid = false;
+    m_wipePending = false;
+    m_stats = {};
+    m_jobs = nullptr;
+    m_idle = nullptr;
+    m_task = nullptr;
+    memset(m_layers, 0, sizeof(m_layers));
+    m_lastMetricsSave = 0;
 }
 
 void EinkDisplayManager::begin()
 {
     Serial.println("Initializing display...");
     // Use false for second parameter to prevent full refresh on each boot
-    m_display.init(115200, false, 10, false);
+    m_epd.init(115200, false, 10, false);
     m_display.setRotation(0);
     m_display.setTextColor(GxEPD_BLACK);
+    if (!m_shown)
+    {
+        m_shown = (uint8_t *)malloc(m_display.byteSize());
+        if (!m_shown)
+        {
+            Serial.println("No memory for the shown frame, diffing disabled");
+        }
+    }
     m_state.initialized = true;
     m_state.sleeping = false;
+
+    // Before the first refresh, which would otherwise be recorded into
+    // histograms the load then replaces
+    loadMetrics();
+
+    // Sleep through BUSY waits instead of spinning on the pin
+    m_epd.setBusyCallback(busyCallback);
+    attachInterrupt(digitalPinToInterrupt(EPD_BUSY), busyInterrupt, RISING);
+
+    // Refreshes run on their own task, reading the shown frame, so the loop
+    // keeps polling buttons and drawing the next screen during a waveform
+    if (m_shown && !m_task)
+    {
+        m_jobs = xQueueCreate(1, sizeof(RefreshJob));
+        m_idle = xSemaphoreCreateBinary();
+        if (m_jobs && m_idle)
+        {
+            xSemaphoreGive(m_idle);
+            if (xTaskCreatePinnedToCore(taskEntry, "display", TASK_STACK_SIZE, this, TASK_PRIORITY, &m_task, TASK_CORE) != pdPASS)
+            {
+                Serial.println("Failed to start display task, refreshing synchronously");
+                m_task = nullptr;
+            }
+        }
+    }
 }
 
 void EinkDisplayManager::sleep()
@@ -22,7 +350,9 @@ void EinkDisplayManager::sleep()
     if (!m_state.initialized)
         return;
     Serial.println("[DISPLAY] EinkDisplayManager::sleep() - Putting display to hibernate mode");
-    m_display.hibernate();
+    waitForRefresh();
+    saveMetrics();
+    m_epd.hibernate();
     m_state.sleeping = true;
     Serial.println("[DISPLAY] Display hibernation complete");
 }
@@ -32,7 +362,7 @@ void EinkDisplayManager::wake()
     if (m_state.sleeping)
     {
         Serial.println("[DISPLAY] EinkDisplayManager::wake() - Waking display from hibernate");
-        m_display.init(115200, true, 2, false);
+        m_epd.init(115200, true, 2, false);
         m_state.sleeping = false;
         // Mark as dirty to ensure content gets redrawn
         m_state.dirty = true;
@@ -48,13 +378,52 @@ void EinkDisplayManager::startDrawing()
 {
     if (!m_state.initialized)
         return;
-    m_display.setFullWindow();
     m_display.fillScreen(GxEPD_WHITE);
 }
 
+void EinkDisplayManager::startDrawing(int16_t x, int16_t y, int16_t w, int16_t h)
+{
+    if (!m_state.initialized)
+        return;
+    m_display.fillRect(x, y, w, h, GxEPD_WHITE);
+}
+
 void EinkDisplayManager::endDrawing()
 {
+    // Layers sit on top of whatever the screen drew
+    for (int i = 0; i < LAYER_COUNT; i++)
+    {
+        paintLayer((DisplayLayer)i);
+    }
+    m_state.dirty = true;
+}
+
+void EinkDisplayManager::setLayer(DisplayLayer layer, int16_t x, int16_t y, int16_t w, int16_t h, LayerPainter paint)
+{
+    if (layer >= LAYER_COUNT)
+        return;
+    m_layers[layer] = {{x, y, w, h}, paint};
+}
+
+void EinkDisplayManager::refreshLayer(DisplayLayer layer, DisplayUpdateMode mode)
+{
+    if (!m_state.initialized || layer >= LAYER_COUNT || !m_layers[layer].paint)
+        return;
+
+    // Only the layer's rows are drawn, so the diff limits the refresh to them
+    // and the content underneath stays as it is
+    paintLayer(layer);
     m_state.dirty = true;
+    update(mode);
+}
+
+void EinkDisplayManager::paintLayer(DisplayLayer layer)
+{
+    const LayerState &state = m_layers[layer];
+    if (!state.paint)
+        return;
+    m_display.fillRect(state.rect.x, state.rect.y, state.rect.w, state.rect.h, GxEPD_WHITE);
+    state.paint();
 }
 
 void EinkDisplayManager::update(DisplayUpdateMode mode)
@@ -62,38 +431,486 @@ void EinkDisplayManager::update(DisplayUpdateMode mode)
     if (!m_state.initialized || !m_state.dirty)
         return;
 
+    unsigned long startedUs = micros();
+
+    // The shown frame is the display task's source until its refresh is done
+    waitForRefresh();
+
     bool partial_update = (mode == UPDATE_PARTIAL);
 
-    if (mode == UPDATE_FAST)
+    // A pending wipe whitens the previous frame before the diff, so the
+    // refresh redraws every black pixel of the new one over the wiped area
+    DirtyRect wipeArea = {};
+    bool wipe = m_wipePending && partial_update && planWipe(wipeArea);
+    m_wipePending = false;
+
+    // Compare with what the panel shows, so only pixels that really changed
+    // are refreshed however much of the frame a screen redrew
+    m_stats.lastPixels = 0;
+    if (m_shownValid)
     {
-        partial_update = true;
+        m_stats.lastPixels = m_display.narrowDirty(m_shown);
+        if (partial_update && !wipe && !m_display.isDirty())
+        {
+            m_stats.skipped++;
+            m_state.dirty = false;
+            return;
+        }
     }
 
-    // Check if we need to wipe screen due to too many partial updates
-    const int MAX_PARTIAL_UPDATES = 10;
-    if (partial_update && m_state.partial_update_count >= MAX_PARTIAL_UPDATES)
+    // Charge the tiles this refresh changes before the shown frame moves on
+    if (partial_update)
     {
-        Serial.println("Auto-wiping screen after multiple partial updates");
-        wipeScreen();
-        m_state.partial_update_count = 0;
+        accountGhosting();
     }
 
-    // Use standard display update for all modes
-    m_display.display(partial_update);
-
-    if (!partial_update)
+    // Partial updates only send and refresh the regions that changed
+    RefreshJob job = {};
+    if (!partial_update || !planWindows(job))
     {
-        m_state.last_full_refresh = millis();
-        m_state.partial_update_count = 0;
+        planFrame(job, partial_update);
+    }
+    job.fast = mode == UPDATE_FAST;
+    job.kind = mode == UPDATE_FULL   ? RefreshMetrics::KIND_FULL
+               : mode == UPDATE_FAST ? RefreshMetrics::KIND_FAST
+                                     : RefreshMetrics::KIND_PARTIAL;
+    job.startedUs = startedUs;
+    job.wipe = wipe;
+    job.wipeArea = wipeArea;
+    if (partial_update)
+    {
+        job.clean = planCleanup(job.cleanArea);
+    }
+    else if (mode == UPDATE_FAST)
+    {
+        memset(m_ghost, GHOST_AFTER_FAST, sizeof(m_ghost));
     }
     else
     {
-        m_state.partial_update_count++;
+        memset(m_ghost, 0, sizeof(m_ghost));
+        m_state.last_full_refresh = millis();
+    }
+    submit(job);
+
+    m_stats.updates++;
+    m_stats.totalBytes += m_stats.lastBytes;
+    m_stats.totalPixels += m_stats.lastPixels;
+    Serial.println("[DISPLAY] " + String(partial_update ? "Partial" : mode == UPDATE_FAST ? "Fast" : "Full") + " refresh: " +
+                   String(m_stats.lastWindows) + " windows, " + String(m_stats.lastBytes) + " bytes, " +
+                   String(m_stats.lastPixels) + " pixels changed");
+
+    if (millis() - m_lastMetricsSave >= METRICS_SAVE_INTERVAL)
+    {
+        saveMetrics();
     }
 
     m_state.dirty = false;
 }
 
+void EinkDisplayManager::loadMetrics()
+{
+    m_metrics.load(SPIFFS, METRICS_PATH);
+    m_lastMetricsSave = millis();
+}
+
+void EinkDisplayManager::saveMetrics()
+{
+    m_metrics.save(SPIFFS, METRICS_PATH);
+    m_lastMetricsSave = millis();
+}
+
+void EinkDisplayManager::accountGhosting()
+{
+    // A tile is charged once per partial refresh that changes any of its pixels
+    bool hit[GHOST_ROWS][GHOST_COLS] = {};
+    const uint8_t *frame = m_display.data();
+    size_t rowBytes = m_display.byteSize() / m_display.rawHeight();
+    for (int16_t y = m_display.dirtyTop(); y <= m_display.dirtyBottom(); y++)
+    {
+        int16_t x0, x1;
+        if (!m_display.dirtySpan(y, x0, x1))
+            continue;
+
+        const uint8_t *now = frame + y * rowBytes;
+        const uint8_t *before = m_shown + y * rowBytes;
+        for (int16_t b = x0 / 8; b <= x1 / 8; b++)
+        {
+            if (!m_shownValid || now[b] != before[b])
+            {
+                hit[y / GHOST_TILE][b * 8 / GHOST_TILE] = true;
+            }
+        }
+    }
+
+    for (int row = 0; row < GHOST_ROWS; row++)
+    {
+        for (int col = 0; col < GHOST_COLS; col++)
+        {
+            if (hit[row][col] && m_ghost[row][col] < 255)
+                m_ghost[row][col]++;
+        }
+    }
+}
+
+bool EinkDisplayManager::planCleanup(DirtyRect &area)
+{
+    int left = GHOST_COLS, top = GHOST_ROWS, right = -1, bottom = -1;
+    for (int row = 0; row < GHOST_ROWS; row++)
+    {
+        for (int col = 0; col < GHOST_COLS; col++)
+        {
+            if (m_ghost[row][col] >= GHOST_BUDGET)
+            {
+                left = std::min(left, col);
+                right = std::max(right, col);
+                top = std::min(top, row);
+                bottom = std::max(bottom, row);
+            }
+        }
+    }
+    if (right < 0)
+        return false;
+
+    // Every tile inside the window gets cleaned, not only those over budget
+    for (int row = top; row <= bottom; row++)
+    {
+        for (int col = left; col <= right; col++)
+        {
+            m_ghost[row][col] = 0;
+        }
+    }
+
+    area.x = left * GHOST_TILE;
+    area.y = top * GHOST_TILE;
+    area.w = std::min<int16_t>((right + 1) * GHOST_TILE, m_display.rawWidth()) - area.x;
+    area.h = std::min<int16_t>((bottom + 1) * GHOST_TILE, m_display.rawHeight()) - area.y;
+    Serial.println("[DISPLAY] Ghost cleanup of " + String(area.w) + "x" + String(area.h) + " at " + String(area.x) + "," + String(area.y));
+    return true;
+}
+
+bool EinkDisplayManager::planWipe(DirtyRect &area)
+{
+    // Bounding box of the black pixels the panel shows
+    size_t rowBytes = m_display.byteSize() / m_display.rawHeight();
+    int16_t top = -1, bottom = -1;
+    int left = rowBytes, right = -1;
+    for (int16_t y = 0; y < m_display.rawHeight(); y++)
+    {
+        const uint8_t *row = m_shown + y * rowBytes;
+        int first = 0;
+        while (first < (int)rowBytes && row[first] == 0xFF)
+            first++;
+        if (first == (int)rowBytes)
+            continue;
+        int last = rowBytes - 1;
+        while (row[last] == 0xFF)
+            last--;
+
+        if (top < 0)
+            top = y;
+        bottom = y;
+        left = std::min(left, first);
+        right = std::max(right, last);
+    }
+    if (top < 0)
+        return false;
+
+    area.x = left * 8;
+    area.y = top;
+    area.w = (right - left + 1) * 8;
+    area.h = bottom - top + 1;
+
+    // After the pass the panel is white there and its tiles are clean
+    for (int16_t y = top; y <= bottom; y++)
+    {
+        memset(m_shown + y * rowBytes + left, 0xFF, right - left + 1);
+    }
+    for (int row = top / GHOST_TILE; row <= bottom / GHOST_TILE; row++)
+    {
+        for (int col = area.x / GHOST_TILE; col <= (area.x + area.w - 1) / GHOST_TILE; col++)
+        {
+            m_ghost[row][col] = 0;
+        }
+    }
+    Serial.println("[DISPLAY] Wipe of " + String(area.w) + "x" + String(area.h) + " at " + String(area.x) + "," + String(area.y));
+    return true;
+}
+
+FrameBuffer *EinkDisplayManager::createFrame()
+{
+    FrameBuffer *frame = new FrameBuffer(m_display.rawWidth(), m_display.rawHeight());
+    if (!frame->isAllocated())
+    {
+        delete frame;
+        return nullptr;
+    }
+    frame->setRotation(m_display.getRotation());
+    return frame;
+}
+
+void EinkDisplayManager::planFrame(RefreshJob &job, bool partial_update)
+{
+    job.partial = partial_update;
+    job.count = 0;
+    job.area = {0, 0, m_display.rawWidth(), m_display.rawHeight()};
+
+    rememberShown(0, m_display.rawHeight());
+    m_shownValid = m_shown != nullptr;
+    m_stats.lastBytes = m_display.byteSize();
+    m_stats.lastWindows = 0;
+    m_display.clearDirty();
+}
+
+void EinkDisplayManager::rememberShown(int16_t top, int16_t bottom)
+{
+    if (!m_shown)
+        return;
+    size_t rowBytes = m_display.byteSize() / m_display.rawHeight();
+    memcpy(m_shown + top * rowBytes, m_display.data() + top * rowBytes, (bottom - top) * rowBytes);
+}
+
+bool EinkDisplayManager::planWindows(RefreshJob &job)
+{
+    int count = m_display.dirtyRects(job.windows, MAX_DIRTY_WINDOWS, DIRTY_MERGE_GAP);
+    if (count == 0)
+        return false;
+
+    // Controller RAM is addressed in whole bytes along x
+    int16_t rawWidth = m_display.rawWidth();
+    int16_t rawHeight = m_display.rawHeight();
+    long area = 0;
+    for (int i = 0; i < count; i++)
+    {
+        DirtyRect &r = job.windows[i];
+        int16_t left = r.x & ~7;
+        int16_t right = std::min<int16_t>((r.x + r.w + 7) & ~7, rawWidth);
+        r.x = left;
+        r.w = right - left;
+        area += (long)r.w * r.h;
+    }
+    if (area * 100 > (long)rawWidth * rawHeight * DIRTY_FULL_PERCENT)
+        return false;
+
+    // Only the windows are sent, then a single waveform runs over their
+    // bounding box; pixels the controller sees unchanged are not driven
+    int16_t top = rawHeight, bottom = 0, left = rawWidth, right = 0;
+    m_stats.lastBytes = 0;
+    for (int i = 0; i < count; i++)
+    {
+        const DirtyRect &r = job.windows[i];
+        top = std::min(top, r.y);
+        bottom = std::max<int16_t>(bottom, r.y + r.h);
+        left = std::min(left, r.x);
+        right = std::max<int16_t>(right, r.x + r.w);
+        m_stats.lastBytes += (r.w / 8) * r.h;
+    }
+    job.partial = true;
+    job.count = count;
+    job.area = {left, top, (int16_t)(right - left), (int16_t)(bottom - top)};
+
+    rememberShown(top, bottom);
+    m_stats.lastWindows = count;
+    m_display.clearDirty();
+    return true;
+}
+
+void EinkDisplayManager::submit(const RefreshJob &job)
+{
+    if (!m_task)
+    {
+        runJob(job, m_shown ? m_shown : m_display.data());
+        return;
+    }
+    xSemaphoreTake(m_idle, portMAX_DELAY);
+    xQueueSend(m_jobs, &job, portMAX_DELAY);
+}
+
+void EinkDisplayManager::runJob(const RefreshJob &job, const uint8_t *frame)
+{
+    int16_t rawWidth = m_display.rawWidth();
+    int16_t rawHeight = m_display.rawHeight();
+
+    // SPI time covers the image writes, BUSY time the refresh commands,
+    // which return once the panel has finished the waveform
+    unsigned long spiUs = 0;
+    unsigned long busyUs = 0;
+    unsigned long t;
+
+    if (job.wipe)
+    {
+        // Only the previously-black pixels differ from white in the
+        // controller's RAM, so they alone are driven
+        const DirtyRect &w = job.wipeArea;
+        unsigned long wipeStart = micros();
+        for (int pass = 0; pass < 2; pass++)
+        {
+            t = micros();
+            for (int16_t y = w.y; y < w.y + w.h; y += WIPE_STRIP_ROWS)
+            {
+                int16_t rows = std::min<int16_t>(WIPE_STRIP_ROWS, w.y + w.h - y);
+                if (pass == 0)
+                {
+                    m_epd.writeImagePart(WIPE_STRIP, w.x, 0, rawWidth, WIPE_STRIP_ROWS, w.x, y, w.w, rows, true);
+                }
+                else
+                {
+                    m_epd.writeImagePartAgain(WIPE_STRIP, w.x, 0, rawWidth, WIPE_STRIP_ROWS, w.x, y, w.w, rows, true);
+                }
+            }
+            spiUs += micros() - t;
+
+            if (pass == 0)
+            {
+                t = micros();
+                m_epd.refresh(w.x, w.y, w.w, w.h);
+                busyUs += micros() - t;
+            }
+        }
+        m_metrics.record(RefreshMetrics::KIND_WIPE, spiUs / 1000, busyUs / 1000, (micros() - wipeStart) / 1000);
+        spiUs = 0;
+        busyUs = 0;
+    }
+
+    t = micros();
+    if (job.count == 0)
+    {
+        // Same sequence GxEPD2_BW::display() uses for a full-height buffer
+        if (job.partial)
+        {
+            m_epd.writeImage(frame, 0, 0, rawWidth, rawHeight);
+        }
+        else
+        {
+            m_epd.writeImageForFullRefresh(frame, 0, 0, rawWidth, rawHeight);
+        }
+        spiUs += micros() - t;
+
+        t = micros();
+        if (job.fast)
+        {
+            m_epd.refreshFast();
+        }
+        else
+        {
+            m_epd.refresh(job.partial);
+        }
+        busyUs += micros() - t;
+
+        // The controller diffs against its previous-image RAM, keep it in sync
+        t = micros();
+        m_epd.writeImageAgain(frame, 0, 0, rawWidth, rawHeight);
+        spiUs += micros() - t;
+
+        if (!job.partial)
+        {
+            t = micros();
+            m_epd.powerOff();
+            busyUs += micros() - t;
+        }
+    }
+    else
+    {
+        for (int i = 0; i < job.count; i++)
+        {
+            const DirtyRect &r = job.windows[i];
+            m_epd.writeImagePart(frame, r.x, r.y, rawWidth, rawHeight, r.x, r.y, r.w, r.h);
+        }
+        spiUs += micros() - t;
+
+        t = micros();
+        m_epd.refresh(job.area.x, job.area.y, job.area.w, job.area.h);
+        busyUs += micros() - t;
+
+        t = micros();
+        for (int i = 0; i < job.count; i++)
+        {
+            const DirtyRect &r = job.windows[i];
+            m_epd.writeImagePartAgain(frame, r.x, r.y, rawWidth, rawHeight, r.x, r.y, r.w, r.h);
+        }
+        spiUs += micros() - t;
+    }
+    m_metrics.record(job.kind, spiUs / 1000, busyUs / 1000, (micros() - job.startedUs) / 1000);
+
+    if (job.clean)
+    {
+        // Drive every pixel of the window to its inverse and back, with the
+        // controller's previous-image RAM kept in step for each pass
+        const DirtyRect &c = job.cleanArea;
+        unsigned long cleanStart = micros();
+        spiUs = 0;
+        busyUs = 0;
+        for (int pass = 0; pass < 2; pass++)
+        {
+            bool invert = pass == 0;
+            t = micros();
+            m_epd.writeImagePart(frame, c.x, c.y, rawWidth, rawHeight, c.x, c.y, c.w, c.h, invert);
+            spiUs += micros() - t;
+
+            t = micros();
+            m_epd.refresh(c.x, c.y, c.w, c.h);
+            busyUs += micros() - t;
+
+            t = micros();
+            m_epd.writeImagePartAgain(frame, c.x, c.y, rawWidth, rawHeight, c.x, c.y, c.w, c.h, invert);
+            spiUs += micros() - t;
+        }
+        m_metrics.record(RefreshMetrics::KIND_CLEANUP, spiUs / 1000, busyUs / 1000, (micros() - cleanStart) / 1000);
+    }
+}
+
+void EinkDisplayManager::waitForRefresh()
+{
+    if (!m_task)
+        return;
+    xSemaphoreTake(m_idle, portMAX_DELAY);
+    xSemaphoreGive(m_idle);
+}
+
+bool EinkDisplayManager::isRefreshing() const
+{
+    return m_task && uxSemaphoreGetCount(m_idle) == 0;
+}
+
+void EinkDisplayManager::taskEntry(void *param)
+{
+    EinkDisplayManager *self = static_cast<EinkDisplayManager *>(param);
+    RefreshJob job;
+    for (;;)
+    {
+        if (xQueueReceive(self->m_jobs, &job, portMAX_DELAY) == pdTRUE)
+        {
+            self->runJob(job, self->m_shown);
+            xSemaphoreGive(self->m_idle);
+        }
+    }
+}
+
+void EinkDisplayManager::busyCallback(const void *param)
+{
+    // GxEPD2 calls this while BUSY is asserted; block until the interrupt on
+    // its release rather than spinning, so the other tasks keep the CPU
+    s_busyWaiter = xTaskGetCurrentTaskHandle();
+    if (digitalRead(EPD_BUSY) == BUSY_LEVEL)
+    {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(BUSY_POLL_MS));
+    }
+    s_busyWaiter = nullptr;
+}
+
+void IRAM_ATTR EinkDisplayManager::busyInterrupt()
+{
+    TaskHandle_t waiter = s_busyWaiter;
+    if (waiter)
+    {
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveFromISR(waiter, &woken);
+        if (woken)
+        {
+            portYIELD_FROM_ISR();
+        }
+    }
+}
+
 void EinkDisplayManager::drawCenteredText(const char *text, int y, const GFXfont *font)
 {
     if (!m_state.initialized)
@@ -106,6 +923,23 @@ void EinkDisplayManager::drawCenteredText(const char *text, int y, const GFXfont
     m_display.print(text);
 }
 
+// 2x2 ordered pattern and the cells of it left white for each gray level:
+// black, a quarter, three quarters, white
+static const uint8_t GRAY_FOLD_PATTERN[2][2] = {{0, 2}, {3, 1}};
+static const uint8_t GRAY_FOLD_WHITE[4] = {0, 1, 3, 4};
+
+void EinkDisplayManager::writeGrayRow(int16_t x, int16_t y, const uint8_t *hi, const uint8_t *lo, int16_t width)
+{
+    const uint8_t *pattern = GRAY_FOLD_PATTERN[y & 1];
+    for (int16_t i = 0; i < width; i++)
+    {
+        uint8_t mask = 0x80 >> (i & 7);
+        int level = ((hi[i >> 3] & mask) ? 2 : 0) | ((lo[i >> 3] & mask) ? 1 : 0);
+        bool white = pattern[(x + i) & 1] < GRAY_FOLD_WHITE[level];
+        m_display.drawPixel(x + i, y, white ? GxEPD_WHITE : GxEPD_BLACK);
+    }
+}
+
 void EinkDisplayManager::drawBatteryIcon(int x, int y, float battery_voltage, bool charging)
 {
     if (!m_state.initialized)
@@ -199,26 +1033,14 @@ void EinkDisplayManager::wipeScreen()
     if (!m_state.initialized)
         return;
 
-    m_display.setPartialWindow(0, 0, m_display.width(), m_display.height());
-
-    m_display.firstPage();
-    do
-    {
-        m_display.fillRect(0, 0, m_display.width(), m_display.height(), GxEPD_BLACK);
-    } while (m_display.nextPage());
-
-    delay(10);
+    m_display.fillScreen(GxEPD_WHITE);
+    m_state.dirty = true;
 
-    m_display.firstPage();
-    do
+    // Without a known frame only a full waveform clears the panel
+    if (!m_shownValid)
     {
-        m_display.fillRect(0, 0, m_display.width(), m_display.height(), GxEPD_WHITE);
-    } while (m_display.nextPage());
-
-    m_display.setFullWindow();
-}
-
-void EinkDisplayManager::resetPartialUpdateCount()
-{
-    m_state.partial_update_count = 0;
+        update(UPDATE_FULL);
+        return;
+    }
+    m_wipePending = true;
 }
\ No newline at end of file
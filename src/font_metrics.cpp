@@ -0,0 +1,70 @@
+#include "font_metrics.h"
+
+// Bundled FreeMono / FreeMonoBold fonts: every glyph has the same xAdvance
+struct MonospaceFont
+{
+    uint8_t yAdvance;
+    uint8_t xAdvance;
+};
+
+static constexpr MonospaceFont BUNDLED_FONTS[] = {
+    {18, 11}, // FreeMono9pt7b, FreeMonoBold9pt7b
+    {24, 14}, // FreeMono12pt7b, FreeMonoBold12pt7b
+    {35, 21}, // FreeMono18pt7b, FreeMonoBold18pt7b
+};
+
+static uint8_t glyphAdvance(const GFXfont *font, uint8_t c)
+{
+    uint16_t first = pgm_read_word(&font->first);
+    uint16_t last = pgm_read_word(&font->last);
+    if (c < first || c > last)
+    {
+        return 0;
+    }
+    GFXglyph *glyphs = (GFXglyph *)pgm_read_ptr(&font->glyph);
+    return pgm_read_byte(&glyphs[c - first].xAdvance);
+}
+
+FontMetrics FontMetrics::forFont(const GFXfont *font)
+{
+    if (!font)
+    {
+        // Built-in 6x8 font at text size 1
+        return FontMetrics(nullptr, 6, 8);
+    }
+
+    uint8_t yAdvance = pgm_read_byte(&font->yAdvance);
+    uint8_t space = glyphAdvance(font, ' ');
+
+    for (const MonospaceFont &bundled : BUNDLED_FONTS)
+    {
+        // Spot-check a narrow and a wide glyph to make sure it really is monospaced
+        if (bundled.yAdvance == yAdvance && bundled.xAdvance == space &&
+            glyphAdvance(font, 'i') == space && glyphAdvance(font, 'W') == space)
+        {
+            return FontMetrics(font, bundled.xAdvance, yAdvance);
+        }
+    }
+
+    FontMetrics metrics(font, 0, yAdvance);
+    metrics.build(font);
+    return metrics;
+}
+
+uint16_t FontMetrics::measure(const char *text, size_t length) const
+{
+    uint16_t width = 0;
+    for (size_t i = 0; i < length; i++)
+    {
+        width += advance(text[i]);
+    }
+    return width;
+}
+
+void FontMetrics::build(const GFXfont *font)
+{
+    for (uint8_t i = 0; i < CHAR_COUNT; i++)
+    {
+        m_advance[i] = glyphAdvance(font, FIRST_CHAR + i);
+    }
+}
@@ -0,0 +1,157 @@
+#include "glyph_blitter.h"
+
+GlyphBlitter::GlyphBlitter() : m_font(nullptr), m_cached(false), m_first(0), m_last(0)
+{
+}
+
+bool GlyphBlitter::setFont(const GFXfont *font)
+{
+    if (font == m_font)
+    {
+        return m_cached;
+    }
+
+    m_font = font;
+    m_cached = false;
+    m_glyphs.clear();
+    m_rows.clear();
+    if (!font)
+    {
+        return false;
+    }
+
+    m_first = pgm_read_word(&font->first);
+    m_last = pgm_read_word(&font->last);
+    const GFXglyph *glyphs = (const GFXglyph *)pgm_read_ptr(&font->glyph);
+    const uint8_t *bitmap = (const uint8_t *)pgm_read_ptr(&font->bitmap);
+
+    m_glyphs.reserve(m_last - m_first + 1);
+    for (uint16_t c = m_first; c <= m_last; c++)
+    {
+        const GFXglyph *glyph = &glyphs[c - m_first];
+        uint16_t offset = pgm_read_word(&glyph->bitmapOffset);
+        uint8_t width = pgm_read_byte(&glyph->width);
+        uint8_t height = pgm_read_byte(&glyph->height);
+        if (width > MAX_GLYPH_WIDTH)
+        {
+            Serial.println("GlyphBlitter: glyph too wide to cache: " + String(width));
+            m_glyphs.clear();
+            m_rows.clear();
+            return false;
+        }
+
+        CachedGlyph cached;
+        cached.row = m_rows.size();
+        cached.height = width ? height : 0;
+        cached.xAdvance = pgm_read_byte(&glyph->xAdvance);
+        cached.xOffset = (int8_t)pgm_read_byte(&glyph->xOffset);
+        cached.yOffset = (int8_t)pgm_read_byte(&glyph->yOffset);
+        m_glyphs.push_back(cached);
+
+        // GFX glyph bitmaps run on across rows, most significant bit first
+        uint8_t bits = 0;
+        uint8_t bit = 0;
+        for (uint8_t y = 0; y < cached.height; y++)
+        {
+            uint32_t row = 0;
+            for (uint8_t x = 0; x < width; x++)
+            {
+                if (!(bit++ & 7))
+                {
+                    bits = pgm_read_byte(&bitmap[offset++]);
+                }
+                if (bits & 0x80)
+                {
+                    row |= 0x80000000u >> x;
+                }
+                bits <<= 1;
+            }
+            m_rows.push_back(row);
+        }
+    }
+
+    m_cached = true;
+    return true;
+}
+
+int16_t GlyphBlitter::drawText(GFXcanvas1 &canvas, int16_t x, int16_t y, const char *text, size_t length, uint16_t color)
+{
+    // Rotated canvases do not use the raw layout, leave those to GFX
+    uint8_t *buffer = canvas.getBuffer();
+    if (!m_cached || !buffer || canvas.getRotation() != 0)
+    {
+        canvas.setFont(m_font);
+        canvas.setTextColor(color);
+        canvas.setCursor(x, y);
+        canvas.write((const uint8_t *)text, length);
+        return canvas.getCursorX();
+    }
+
+    const int16_t stride = (canvas.width() + 7) / 8;
+    const int16_t height = canvas.height();
+    const bool black = color == 0;
+
+    for (size_t i = 0; i < length; i++)
+    {
+        uint8_t c = text[i];
+        if (c < m_first || c > m_last)
+        {
+            continue;
+        }
+
+        const CachedGlyph &glyph = m_glyphs[c - m_first];
+        const uint32_t *rows = &m_rows[glyph.row];
+        int16_t gx = x + glyph.xOffset;
+        int16_t gy = y + glyph.yOffset;
+        int16_t column = gx >> 3;
+        uint8_t shift = gx & 7;
+        bool inside = column >= 0 && column + 4 <= stride;
+
+        for (uint8_t r = 0; r < glyph.height; r++)
+        {
+            int16_t py = gy + r;
+            uint32_t bits = rows[r] >> shift;
+            if (py < 0 || py >= height || !bits)
+            {
+                continue;
+            }
+
+            uint8_t *line = buffer + py * stride;
+            if (inside)
+            {
+                uint8_t *dst = line + column;
+                // Common case: four whole bytes of the row, no clipping
+                if (black)
+                {
+                    dst[0] &= ~(uint8_t)(bits >> 24);
+                    dst[1] &= ~(uint8_t)(bits >> 16);
+                    dst[2] &= ~(uint8_t)(bits >> 8);
+                    dst[3] &= ~(uint8_t)bits;
+                }
+                else
+                {
+                    dst[0] |= (uint8_t)(bits >> 24);
+                    dst[1] |= (uint8_t)(bits >> 16);
+                    dst[2] |= (uint8_t)(bits >> 8);
+                    dst[3] |= (uint8_t)bits;
+                }
+                continue;
+            }
+
+            for (int b = 0; b < 4; b++)
+            {
+                uint8_t mask = bits >> (24 - 8 * b);
+                int16_t index = column + b;
+                if (mask && index >= 0 && index < stride)
+                {
+                    if (black)
+                        line[index] &= ~mask;
+                    else
+                        line[index] |= mask;
+                }
+            }
+        }
+        x += glyph.xAdvance;
+    }
+    return x;
+}
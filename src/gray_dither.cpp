@@ -0,0 +1,120 @@
+#include "gray_dither.h"
+#include <algorithm>
+
+// Bayer 4x4 matrix scaled to thresholds over 0..255
+static const uint8_t BAYER_4X4[4][4] = {
+    {8, 136, 40, 168},
+    {200, 72, 232, 104},
+    {56, 184, 24, 152},
+    {248, 120, 216, 88},
+};
+
+GrayDither::GrayDither() : m_width(0), m_row(0), m_kernel(KERNEL_DIFFUSION), m_levels(2)
+{
+}
+
+bool GrayDither::begin(uint16_t width, Kernel kernel, uint8_t levels)
+{
+    m_width = width;
+    m_row = 0;
+    m_kernel = kernel;
+    m_levels = levels;
+    if (kernel == KERNEL_DIFFUSION)
+    {
+        m_error.assign(2 * (width + 2), 0);
+    }
+    else
+    {
+        m_error.clear();
+    }
+    return width > 0 && (levels == 2 || levels == 4);
+}
+
+void GrayDither::end()
+{
+    m_width = 0;
+    std::vector<int16_t>().swap(m_error);
+}
+
+const char *GrayDither::kernelName(Kernel kernel)
+{
+    return kernel == KERNEL_ORDERED ? "ordered" : "diffusion";
+}
+
+void GrayDither::ditherRow(const uint8_t *gray, uint8_t *bits)
+{
+    ditherRow(gray, bits, nullptr);
+}
+
+void GrayDither::ditherRow(const uint8_t *gray, uint8_t *hi, uint8_t *lo)
+{
+    size_t bytes = (m_width + 7) / 8;
+    memset(hi, 0, bytes);
+    if (lo)
+    {
+        memset(lo, 0, bytes);
+    }
+    if (m_kernel == KERNEL_ORDERED)
+    {
+        orderedRow(gray, hi, lo);
+    }
+    else
+    {
+        diffusionRow(gray, hi, lo);
+    }
+    m_row++;
+}
+
+// Set pixel x of a row to level; with no lo plane there are only two levels
+static inline void putLevel(uint8_t *hi, uint8_t *lo, uint16_t x, int level)
+{
+    uint8_t mask = 0x80 >> (x & 7);
+    if (!lo)
+    {
+        if (level)
+            hi[x >> 3] |= mask;
+        return;
+    }
+    if (level & 2)
+        hi[x >> 3] |= mask;
+    if (level & 1)
+        lo[x >> 3] |= mask;
+}
+
+void GrayDither::orderedRow(const uint8_t *gray, uint8_t *hi, uint8_t *lo)
+{
+    // The threshold picks between the two levels either side of the gray
+    int top = lo ? m_levels - 1 : 1;
+    const uint8_t *thresholds = BAYER_4X4[m_row & 3];
+    for (uint16_t x = 0; x < m_width; x++)
+    {
+        putLevel(hi, lo, x, (gray[x] * top + thresholds[x & 3]) >> 8);
+    }
+}
+
+void GrayDither::diffusionRow(const uint8_t *gray, uint8_t *hi, uint8_t *lo)
+{
+    // Error rows are indexed x + 1; the guard columns absorb the spill at the edges
+    size_t stride = m_width + 2;
+    int16_t *cur = &m_error[(m_row & 1) * stride];
+    int16_t *next = &m_error[((m_row + 1) & 1) * stride];
+    memset(next, 0, stride * sizeof(int16_t));
+
+    // Alternate direction each row so the error does not drift into streaks
+    int top = lo ? m_levels - 1 : 1;
+    bool forward = (m_row & 1) == 0;
+    int step = forward ? 1 : -1;
+    int x = forward ? 0 : m_width - 1;
+    for (uint16_t i = 0; i < m_width; i++, x += step)
+    {
+        int value = gray[x] + cur[x + 1];
+        int level = (std::min(255, std::max(0, value)) * top + 127) / 255;
+        int error = value - level * 255 / top;
+        putLevel(hi, lo, x, level);
+
+        cur[x + 1 + step] += (error * 7) >> 4;
+        next[x + 1 - step] += (error * 3) >> 4;
+        next[x + 1] += (error * 5) >> 4;
+        next[x + 1 + step] += error >> 4;
+    }
+}
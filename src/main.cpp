@@ -28,6 +28,17 @@ void setup()
   initPowerManagement();
   handleWakeup();
 
+  // Initialize SPIFFS for WiFi configuration and refresh metrics,
+  // before the display loads the latter
+  if (!SPIFFS.begin(true))
+  {
+    Serial.println("SPIFFS initialization failed");
+  }
+  else
+  {
+    Serial.println("SPIFFS initialized successfully");
+  }
+
   display.begin();
 
   // Check if we're waking from deep sleep
@@ -38,16 +49,6 @@ void setup()
     display.wake();
   }
 
-  // Initialize SPIFFS for WiFi configuration storage
-  if (!SPIFFS.begin(true))
-  {
-    Serial.println("SPIFFS initialization failed");
-  }
-  else
-  {
-    Serial.println("SPIFFS initialized successfully");
-  }
-
   initializeButtons();
   initializeSensors();
   initStorage();
@@ -80,6 +81,7 @@ void loop()
     Serial.println("[MAIN] Inactivity timeout detected, entering deep sleep...");
     Serial.printf("[MAIN] Last activity was %lu ms ago (timeout: %lu ms)\n",
                   millis() - last_activity_time, DEEP_SLEEP_TIMEOUT);
+    saveUIState();
     display.sleep();
     Serial.println("[MAIN] Calling enterDeepSleep(0)");
     enterDeepSleep(0);
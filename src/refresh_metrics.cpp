@@ -0,0 +1,157 @@
+#include "refresh_metrics.h"
+
+const uint16_t LatencyHistogram::BOUNDS_MS[LatencyHistogram::BUCKETS - 1] = {
+    5, 10, 20, 50, 100, 200, 300, 500, 750, 1000, 2000};
+
+static const char *const KIND_NAMES[RefreshMetrics::KIND_COUNT] = {"full", "partial", "fast", "cleanup", "wipe"};
+
+void LatencyHistogram::record(uint32_t ms)
+{
+    int bucket = 0;
+    while (bucket < BUCKETS - 1 && ms >= BOUNDS_MS[bucket])
+    {
+        bucket++;
+    }
+    counts[bucket]++;
+    count++;
+    totalMs += ms;
+    if (ms > maxMs)
+    {
+        maxMs = ms;
+    }
+}
+
+uint32_t LatencyHistogram::percentile(int percent) const
+{
+    if (count == 0)
+    {
+        return 0;
+    }
+
+    uint32_t target = ((uint64_t)count * percent + 99) / 100;
+    uint32_t seen = 0;
+    for (int bucket = 0; bucket < BUCKETS - 1; bucket++)
+    {
+        seen += counts[bucket];
+        if (seen >= target)
+        {
+            return BOUNDS_MS[bucket];
+        }
+    }
+    return maxMs;
+}
+
+RefreshMetrics::RefreshMetrics()
+{
+    m_lock = portMUX_INITIALIZER_UNLOCKED;
+    memset(m_entries, 0, sizeof(m_entries));
+}
+
+void RefreshMetrics::record(Kind kind, uint32_t spiMs, uint32_t busyMs, uint32_t totalMs)
+{
+    if (kind >= KIND_COUNT)
+        return;
+
+    portENTER_CRITICAL(&m_lock);
+    m_entries[kind].spi.record(spiMs);
+    m_entries[kind].busy.record(busyMs);
+    m_entries[kind].total.record(totalMs);
+    portEXIT_CRITICAL(&m_lock);
+}
+
+void RefreshMetrics::reset()
+{
+    portENTER_CRITICAL(&m_lock);
+    memset(m_entries, 0, sizeof(m_entries));
+    portEXIT_CRITICAL(&m_lock);
+}
+
+void RefreshMetrics::snapshot(Entry *out)
+{
+    portENTER_CRITICAL(&m_lock);
+    memcpy(out, m_entries, sizeof(m_entries));
+    portEXIT_CRITICAL(&m_lock);
+}
+
+void RefreshMetrics::print(Print &out)
+{
+    Entry entries[KIND_COUNT];
+    snapshot(entries);
+
+    out.println("Refresh latency (ms)   count      avg   p50   p90   max");
+    for (int kind = 0; kind < KIND_COUNT; kind++)
+    {
+        const Entry &entry = entries[kind];
+        if (entry.total.count == 0)
+        {
+            continue;
+        }
+
+        const LatencyHistogram *parts[] = {&entry.spi, &entry.busy, &entry.total};
+        const char *labels[] = {"spi", "busy", "total"};
+        for (int i = 0; i < 3; i++)
+        {
+            const LatencyHistogram &h = *parts[i];
+            out.printf("%-8s %-6s %12lu %8lu %5lu %5lu %5lu\n", i == 0 ? KIND_NAMES[kind] : "", labels[i],
+                       (unsigned long)h.count, (unsigned long)(h.totalMs / h.count), (unsigned long)h.percentile(50),
+                       (unsigned long)h.percentile(90), (unsigned long)h.maxMs);
+        }
+
+        // Bucket counts of the end-to-end time
+        out.print("         buckets");
+        for (int bucket = 0; bucket < LatencyHistogram::BUCKETS; bucket++)
+        {
+            if (bucket < LatencyHistogram::BUCKETS - 1)
+                out.printf(" <%u:%lu", LatencyHistogram::BOUNDS_MS[bucket], (unsigned long)entry.total.counts[bucket]);
+            else
+                out.printf(" more:%lu", (unsigned long)entry.total.counts[bucket]);
+        }
+        out.println();
+    }
+}
+
+bool RefreshMetrics::load(fs::FS &fs, const char *path)
+{
+    File file = fs.open(path, FILE_READ);
+    if (!file)
+    {
+        return false;
+    }
+
+    FileHeader header;
+    Entry entries[KIND_COUNT];
+    bool ok = file.read((uint8_t *)&header, sizeof(header)) == sizeof(header) && header.magic == FILE_MAGIC &&
+              header.version == FILE_VERSION && header.kinds == KIND_COUNT &&
+              header.buckets == LatencyHistogram::BUCKETS &&
+              file.read((uint8_t *)entries, sizeof(entries)) == sizeof(entries);
+    file.close();
+    if (!ok)
+    {
+        Serial.println("Ignoring refresh stats with another layout: " + String(path));
+        return false;
+    }
+
+    portENTER_CRITICAL(&m_lock);
+    memcpy(m_entries, entries, sizeof(m_entries));
+    portEXIT_CRITICAL(&m_lock);
+    return true;
+}
+
+bool RefreshMetrics::save(fs::FS &fs, const char *path)
+{
+    Entry entries[KIND_COUNT];
+    snapshot(entries);
+
+    File file = fs.open(path, FILE_WRITE);
+    if (!file)
+    {
+        Serial.println("Failed to write refresh stats: " + String(path));
+        return false;
+    }
+
+    FileHeader header = {FILE_MAGIC, FILE_VERSION, KIND_COUNT, LatencyHistogram::BUCKETS};
+    bool ok = file.write((const uint8_t *)&header, sizeof(header)) == sizeof(header) &&
+              file.write((const uint8_t *)entries, sizeof(entries)) == sizeof(entries);
+    file.close();
+    return ok;
+}
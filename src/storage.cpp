@@ -61,6 +61,7 @@ bool initStorage()
     createDirectory("/books");
     createDirectory("/manga");
     createDirectory("/config");
+    createDirectory("/cache");
     createDirectory("/temp");
 
     return true;
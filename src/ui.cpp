@@ -4,6 +4,7 @@
 #include "sensors.h"
 #include "storage.h"
 #include "main.h"
+#include "font_metrics.h"
 #include "ui/wifi/wifi_screen.h"
 #include "ui/files/files_screen.h"
 #include "ui/books/book_screen.h"
@@ -22,6 +23,7 @@ AppScreen current_screen = SCREEN_MAIN_MENU;
 int main_menu_selection = 0; // 0: Books, 1: Settings, 2: Wifi, 3: Clock
 unsigned long last_status_update = 0;
 const unsigned long STATUS_UPDATE_INTERVAL = 300000; // 5 minutes
+const int STATUS_BAR_HEIGHT = 20;                    // Separator line drawn just below
 
 // --- Helper Functions ---
 bool isWifiConnected()
@@ -47,6 +49,9 @@ const int main_menu_item_count = sizeof(main_menu_items) / sizeof(main_menu_item
 
 void initializeUI()
 {
+    // The status bar is a layer of its own, painted over every screen
+    display.setLayer(EinkDisplayManager::LAYER_STATUS_BAR, 0, 0, display.m_display.width(), STATUS_BAR_HEIGHT + 1, drawStatusBar);
+
     // Clear screen to eliminate any startup ghosting
     display.wipeScreen();
 
@@ -92,18 +97,78 @@ void drawCurrentScreen(EinkDisplayManager::DisplayUpdateMode mode)
     }
 }
 
+// Serial console commands, one per line:
+//   find <text>  jump to the next match in the open book; the reading
+//                menu's Search Results lists the pages of its hits
+static void runSerialCommand(String line)
+{
+    line.trim();
+
+    if (line.startsWith("find "))
+    {
+        bool reading = (current_screen == SCREEN_BOOKS || current_screen == SCREEN_BOOK_READER) &&
+                       bookScreen.isBookLoaded() && bookScreen.getCurrentMode() == BookScreen::MODE_BOOK_READER;
+        if (!reading)
+        {
+            Serial.println("Open a book to search");
+        }
+        else if (bookScreen.findNext(line.substring(5)))
+        {
+            resetActivityTimer();
+            bookScreen.drawBookReader(EinkDisplayManager::UPDATE_PARTIAL);
+        }
+    }
+    else if (line == "refresh")
+    {
+        display.getMetrics().print(Serial);
+    }
+    else if (line == "refresh reset")
+    {
+        display.getMetrics().reset();
+        display.saveMetrics();
+        Serial.println("Refresh stats cleared");
+    }
+    else if (line.length() > 0)
+    {
+        Serial.println("Unknown command: " + line);
+    }
+}
+
+// Collects what has arrived without waiting for the rest of the line, so a
+// slow or unterminated line never holds up the UI loop
+static void handleSerialCommands()
+{
+    static const size_t MAX_LINE = 128;
+    static String line;
+
+    while (Serial.available())
+    {
+        char c = Serial.read();
+        if (c == '\n')
+        {
+            runSerialCommand(line);
+            line = "";
+        }
+        else if (line.length() < MAX_LINE)
+        {
+            line += c;
+        }
+    }
+}
+
 void updateUI()
 {
+    handleSerialCommands();
+
     if (millis() - last_status_update > STATUS_UPDATE_INTERVAL)
     {
-        // Only redraw the status bar, using a partial update
-        display.startDrawing();
-        drawStatusBar();
-        display.endDrawing();
-        display.update(EinkDisplayManager::UPDATE_PARTIAL);
+        // Only the status bar layer is repainted and refreshed
+        display.refreshLayer(EinkDisplayManager::LAYER_STATUS_BAR);
         last_status_update = millis();
     }
 
+    bookScreen.update();
+
     // Update WiFi screen if active (for web server handling)
     if (current_screen == SCREEN_WIFI)
     {
@@ -111,14 +176,16 @@ void updateUI()
     }
 }
 
+void saveUIState()
+{
+    bookScreen.saveReadingPosition();
+}
+
 void handleButtonPress(int button)
 {
     // Reset activity timer on any button press
     resetActivityTimer();
 
-    // Reset partial update counter to prevent auto-wipe during navigation
-    display.resetPartialUpdateCount();
-
     if (current_screen == SCREEN_MAIN_MENU)
     {
         int old_selection = main_menu_selection;
@@ -135,10 +202,8 @@ void handleButtonPress(int button)
             current_screen = main_menu_items[main_menu_selection].screen;
             Serial.printf("Entering screen: %d\n", current_screen);
 
-            // Clear screen to eliminate ghosting before drawing new screen
-            display.wipeScreen();
-
-            // Draw the appropriate screen based on selection
+            // Screen switches use the fast full refresh, which clears ghosting
+            // on its own
             switch (current_screen)
             {
             case SCREEN_BOOKS:
@@ -217,7 +282,6 @@ void handleButtonPress(int button)
                     // Return to main menu
                     current_screen = SCREEN_MAIN_MENU;
                     Serial.println("UP pressed - returning to main menu");
-                    display.wipeScreen();
                     drawMainMenu(EinkDisplayManager::UPDATE_FAST);
                 }
             }
@@ -236,7 +300,6 @@ void handleButtonPress(int button)
 void drawMainMenu(EinkDisplayManager::DisplayUpdateMode mode)
 {
     display.startDrawing();
-    drawStatusBar();
 
     // Improved layout parameters (adjusted for new status bar height)
     int start_y = 85;
@@ -315,15 +378,11 @@ void drawStatusBar()
     String time_str = formatTime(current_time);
     TimeStatus time_status = getTimeStatus();
 
-    // Improved status bar height and styling
-    int status_height = 20;
-    display.m_display.fillRect(0, 0, display.m_display.width(), status_height, GxEPD_WHITE);
+    // Improved status bar height and styling; the layer is cleared before painting
+    int status_height = STATUS_BAR_HEIGHT;
 
     // Time display with better font and positioning
     display.m_display.setFont(&FreeMono9pt7b);
-    int16_t x1, y1;
-    uint16_t w, h;
-    display.m_display.getTextBounds(time_str.c_str(), 0, 0, &x1, &y1, &w, &h);
     display.m_display.setCursor(8, 16);
     display.m_display.print(time_str);
 
@@ -332,8 +391,8 @@ void drawStatusBar()
     battery_percent = constrain(battery_percent, 0, 100);
     String battery_text = String(battery_percent) + "%";
 
-    // Get battery text dimensions for proper positioning
-    display.m_display.getTextBounds(battery_text.c_str(), 0, 0, &x1, &y1, &w, &h);
+    // Get battery text width for proper positioning (advance table, no glyph bounds pass)
+    uint16_t w = FontMetrics::forFont(&FreeMono9pt7b).measure(battery_text.c_str(), battery_text.length());
 
     // Position battery elements from right edge
     int battery_icon_x = display.m_display.width() - 25; // Battery icon position
@@ -496,7 +555,6 @@ void handleDownAction()
 void drawSettingsScreen(EinkDisplayManager::DisplayUpdateMode mode)
 {
     display.startDrawing();
-    drawStatusBar();
 
     display.m_display.setFont(&FreeMonoBold18pt7b);
     display.drawCenteredText("Settings", 100, &FreeMonoBold18pt7b);
@@ -514,7 +572,6 @@ void drawWifiScreen(EinkDisplayManager::DisplayUpdateMode mode)
 void drawClockScreen(EinkDisplayManager::DisplayUpdateMode mode)
 {
     display.startDrawing();
-    drawStatusBar();
 
     display.m_display.setFont(&FreeMonoBold18pt7b);
     display.drawCenteredText("Time & Date", 100, &FreeMonoBold18pt7b);
@@ -0,0 +1,240 @@
+#include "book_ingest.h"
+#include "book_screen.h"
+#include "epub_reader.h"
+#include "html_text_filter.h"
+#include "page_index.h"
+#include "plain_text_filter.h"
+#include "../../../include/storage.h"
+#include <algorithm>
+
+static const uint32_t BOOK_MAGIC = 0x4B4F4F42; // "BOOK"
+
+// Conversion works in small chunks, so memory use is independent of book size
+static const size_t CHUNK_SIZE = 512;
+
+bool BookIngest::ingest(const String &source)
+{
+    CompactBook existing;
+    if (open(source, existing))
+    {
+        return true;
+    }
+
+    BookFormat format = BookScreen::detectBookFormat(source);
+    uint32_t sourceSize = 0;
+    uint32_t sourceModified = 0;
+    if (format == FORMAT_UNKNOWN || !readSource(source, sourceSize, sourceModified))
+    {
+        return false;
+    }
+
+    unsigned long startTime = millis();
+    createDirectory("/cache");
+
+    // A stale header must not outlive the text it describes
+    String headerPath = cachePath(source, ".bk");
+    String textPath = cachePath(source, ".txt");
+    deleteFile(headerPath);
+
+    File target = SD.open(textPath, FILE_WRITE);
+    if (!target)
+    {
+        Serial.println("Failed to create book text: " + textPath);
+        return false;
+    }
+
+    std::vector<uint32_t> chapters;
+    uint32_t length = 0;
+    bool ok = format == FORMAT_EPUB ? convertEpub(source, target, chapters, length)
+                                    : convertTxt(source, target, chapters, length);
+    target.close();
+
+    if (!ok || length == 0)
+    {
+        Serial.println("Failed to convert book: " + source);
+        deleteFile(textPath);
+        return false;
+    }
+
+    File file = SD.open(headerPath, FILE_WRITE);
+    if (!file)
+    {
+        Serial.println("Failed to create book header: " + headerPath);
+        return false;
+    }
+
+    Header header = {BOOK_MAGIC, FORMAT_VERSION, 0, sourceSize, sourceModified, length, (uint32_t)chapters.size()};
+    size_t chapterBytes = chapters.size() * sizeof(uint32_t);
+    ok = file.write((const uint8_t *)&header, sizeof(header)) == sizeof(header) &&
+         file.write((const uint8_t *)chapters.data(), chapterBytes) == chapterBytes;
+    file.close();
+
+    if (!ok)
+    {
+        deleteFile(headerPath);
+        return false;
+    }
+
+    Serial.println("Ingested " + source + ": " + String(length) + " bytes of text, " + String(chapters.size()) +
+                   " chapters in " + String(millis() - startTime) + "ms");
+    return true;
+}
+
+bool BookIngest::open(const String &source, CompactBook &book)
+{
+    uint32_t sourceSize = 0;
+    uint32_t sourceModified = 0;
+    if (!readSource(source, sourceSize, sourceModified))
+    {
+        return false;
+    }
+
+    File file = SD.open(cachePath(source, ".bk"), FILE_READ);
+    if (!file)
+    {
+        return false;
+    }
+
+    Header header;
+    bool valid = file.read((uint8_t *)&header, sizeof(header)) == sizeof(header) &&
+                 header.magic == BOOK_MAGIC &&
+                 header.version == FORMAT_VERSION &&
+                 header.sourceSize == sourceSize &&
+                 header.sourceModified == sourceModified &&
+                 file.size() == sizeof(Header) + header.chapterCount * sizeof(uint32_t);
+
+    if (valid)
+    {
+        book.chapters.resize(header.chapterCount);
+        size_t chapterBytes = header.chapterCount * sizeof(uint32_t);
+        valid = file.read((uint8_t *)book.chapters.data(), chapterBytes) == chapterBytes;
+    }
+    file.close();
+
+    book.textPath = cachePath(source, ".txt");
+    book.textLength = header.textLength;
+    return valid && getFileSize(book.textPath) == header.textLength;
+}
+
+void BookIngest::remove(const String &source)
+{
+    deleteFile(cachePath(source, ".bk"));
+    deleteFile(cachePath(source, ".txt"));
+}
+
+String BookIngest::cachePath(const String &source, const char *extension)
+{
+    // Hash of the book path plus its size keeps cache names short and unique
+    String key = source + ":" + String(getFileSize(source));
+    uint32_t hash = PageIndex::hash(key.c_str(), key.length());
+
+    char name[24];
+    snprintf(name, sizeof(name), "/cache/%08lx", (unsigned long)hash);
+    return String(name) + extension;
+}
+
+bool BookIngest::convertTxt(const String &source, File &target, std::vector<uint32_t> &chapters, uint32_t &length)
+{
+    File input = SD.open(source, FILE_READ);
+    if (!input)
+    {
+        Serial.println("Failed to open TXT file: " + source);
+        return false;
+    }
+
+    char *buffer = (char *)malloc(CHUNK_SIZE * 2 + 2);
+    if (!buffer)
+    {
+        input.close();
+        return false;
+    }
+
+    char *output = buffer + CHUNK_SIZE;
+    PlainTextFilter filter;
+    bool ok = true;
+    size_t bytesRead;
+
+    while (ok && (bytesRead = input.read((uint8_t *)buffer, CHUNK_SIZE)) > 0)
+    {
+        size_t filtered = filter.feed(buffer, bytesRead, output);
+        ok = target.write((const uint8_t *)output, filtered) == filtered;
+        length += filtered;
+        yield();
+    }
+
+    free(buffer);
+    input.close();
+
+    chapters = filter.headings();
+    return ok;
+}
+
+bool BookIngest::convertEpub(const String &source, File &target, std::vector<uint32_t> &chapters, uint32_t &length)
+{
+    EpubReader epub;
+    if (!epub.open(source))
+    {
+        Serial.println("Failed to open EPUB file: " + source);
+        return false;
+    }
+
+    char *output = (char *)malloc(CHUNK_SIZE * 2);
+    if (!output)
+    {
+        return false;
+    }
+
+    HtmlTextFilter filter;
+    bool ok = true;
+
+    for (int chapter = 0; ok && chapter < epub.getChapterCount(); chapter++)
+    {
+        // Each spine item starts a new paragraph and a new chapter
+        filter.reset();
+        if (length > 0)
+        {
+            length += target.write((const uint8_t *)"\n\n", 2);
+        }
+        uint32_t chapterStart = length;
+
+        ok = epub.streamChapter(chapter, [&](const char *data, size_t size)
+                                {
+            while (size > 0)
+            {
+                size_t chunk = std::min(size, CHUNK_SIZE);
+                size_t filtered = filter.feed(data, chunk, output);
+                if (target.write((const uint8_t *)output, filtered) != filtered)
+                {
+                    return false;
+                }
+                length += filtered;
+                data += chunk;
+                size -= chunk;
+            }
+            return true; });
+
+        // Spine items without text, such as cover images, are not chapters
+        if (length > chapterStart)
+        {
+            chapters.push_back(chapterStart);
+        }
+        yield();
+    }
+
+    free(output);
+    return ok;
+}
+
+bool BookIngest::readSource(const String &source, uint32_t &size, uint32_t &modified)
+{
+    File file = SD.open(source, FILE_READ);
+    if (!file)
+    {
+        return false;
+    }
+
+    size = file.size();
+    modified = (uint32_t)file.getLastWrite();
+    file.close();
+    return true;
+}
@@ -0,0 +1,55 @@
+#ifndef BOOK_INGEST_H
+#define BOOK_INGEST_H
+
+#include <Arduino.h>
+#include <FS.h>
+#include <SD.h>
+#include <vector>
+
+// Opened form of an ingested book
+struct CompactBook
+{
+    String textPath;                // Normalized text, streamed by the reader
+    uint32_t textLength;
+    std::vector<uint32_t> chapters; // Text offset of each chapter start
+};
+
+// Conversion of TXT and EPUB books into the compact on-SD form.
+// Every book is turned once into normalized plain text under /cache plus a
+// small .bk header holding the source identity and the chapter table; the
+// header is written last, so it only exists for a complete conversion.
+// Opening an ingested book is then one header read and a stream open,
+// whatever its source format was.
+class BookIngest
+{
+public:
+    // Bump whenever the normalized text changes for the same source
+    static const uint16_t FORMAT_VERSION = 1;
+
+    // Convert source unless an up-to-date compact copy already exists
+    static bool ingest(const String &source);
+
+    // Read the header of an up-to-date compact copy of source
+    static bool open(const String &source, CompactBook &book);
+
+    static void remove(const String &source);
+    static String cachePath(const String &source, const char *extension);
+
+private:
+    struct Header
+    {
+        uint32_t magic;
+        uint16_t version;
+        uint16_t reserved;
+        uint32_t sourceSize;
+        uint32_t sourceModified;
+        uint32_t textLength;
+        uint32_t chapterCount;
+    };
+
+    static bool convertTxt(const String &source, File &target, std::vector<uint32_t> &chapters, uint32_t &length);
+    static bool convertEpub(const String &source, File &target, std::vector<uint32_t> &chapters, uint32_t &length);
+    static bool readSource(const String &source, uint32_t &size, uint32_t &modified);
+};
+
+#endif // BOOK_INGEST_H
@@ -2,6 +2,9 @@
 #include "../../../include/storage.h"
 #include "../../../include/power.h"
 #include "../../../include/display.h"
+#include "book_ingest.h"
+#include "book_search.h"
+#include "reading_position.h"
 #include <SD.h>
 #include <algorithm>
 
@@ -32,6 +35,18 @@ BookScreen::BookScreen()
     m_pageInfo.startPosition = 0;
     m_pageInfo.endPosition = 0;
 
+    // Off-screen frames are allocated when a book is first read
+    for (int i = 0; i < PRERENDER_SLOTS; i++)
+    {
+        m_prerendered[i].start = PageLines::NO_PAGE;
+        m_prerendered[i].frame = nullptr;
+    }
+    m_savedPosition = 0;
+    m_positionChangedAt = 0;
+    m_showingHits = false;
+    m_localPage.offset = PageLines::NO_PAGE;
+    m_localPage.length = 0;
+
     // Initialize book menu
     initializeBookMenu();
 
@@ -47,6 +62,28 @@ void BookScreen::draw(EinkDisplayManager::DisplayUpdateMode mode)
         refreshBookList();
     }
 
+    if (m_currentMode == MODE_BOOK_READER && m_cover.isOpen())
+    {
+        m_cover.draw(mode);
+        return;
+    }
+
+    // A page rasterized ahead of time only needs its header brought up to date
+    if (m_currentMode == MODE_BOOK_READER && showPrerenderedPage(mode))
+    {
+        return;
+    }
+
+    // The menu is a popup: while it is open only the dialog box is redrawn
+    // over the page, so opening it and moving the highlight refresh just that window
+    if (m_currentMode == MODE_BOOK_MENU && mode != EinkDisplayManager::UPDATE_FULL)
+    {
+        drawBookMenuDialog();
+        display.endDrawing();
+        display.update(mode);
+        return;
+    }
+
     display.startDrawing();
     drawHeader();
 
@@ -74,6 +111,14 @@ void BookScreen::draw(EinkDisplayManager::DisplayUpdateMode mode)
 
     display.endDrawing();
     display.update(mode);
+
+    // Lay out and rasterize the neighbouring pages while the reader looks at this one
+    if (m_currentMode == MODE_BOOK_READER)
+    {
+        m_positionChangedAt = millis();
+        prefetchPageLines();
+        prerenderPages();
+    }
 }
 
 void BookScreen::drawBookList(EinkDisplayManager::DisplayUpdateMode mode)
@@ -96,6 +141,12 @@ void BookScreen::drawBookMenu(EinkDisplayManager::DisplayUpdateMode mode)
 
 void BookScreen::handleSelectAction()
 {
+    // Any button closes the cover
+    if (closeCover())
+    {
+        return;
+    }
+
     switch (m_currentMode)
     {
     case MODE_BOOK_LIST:
@@ -114,9 +165,10 @@ void BookScreen::handleSelectAction()
 
             if (loadBook(book.filename))
             {
+                // The loading screen was a full refresh; wiping its text is enough
                 setMode(MODE_BOOK_READER);
                 display.wipeScreen();
-                draw(EinkDisplayManager::UPDATE_FULL);
+                draw(EinkDisplayManager::UPDATE_PARTIAL);
             }
             else
             {
@@ -147,6 +199,12 @@ void BookScreen::handleSelectAction()
 
 void BookScreen::handleDownAction()
 {
+    // Any button closes the cover
+    if (closeCover())
+    {
+        return;
+    }
+
     switch (m_currentMode)
     {
     case MODE_BOOK_LIST:
@@ -155,14 +213,13 @@ void BookScreen::handleDownAction()
         {
             if (m_selectedBookIndex < m_availableBooks.size() - 1)
             {
-                m_selectedBookIndex++;
-                draw(EinkDisplayManager::UPDATE_PARTIAL);
+                selectBook(m_selectedBookIndex + 1);
             }
             else if (m_currentBookPage < m_totalBookPages - 1)
             {
                 // Move to next page
                 nextBookPage();
-                draw(EinkDisplayManager::UPDATE_FULL);
+                draw(EinkDisplayManager::UPDATE_FAST);
             }
         }
         break;
@@ -188,6 +245,12 @@ void BookScreen::handleDownAction()
 
 void BookScreen::handleUpAction()
 {
+    // Any button closes the cover
+    if (closeCover())
+    {
+        return;
+    }
+
     switch (m_currentMode)
     {
     case MODE_BOOK_LIST:
@@ -196,15 +259,14 @@ void BookScreen::handleUpAction()
         {
             if (m_selectedBookIndex > 0)
             {
-                m_selectedBookIndex--;
-                draw(EinkDisplayManager::UPDATE_PARTIAL);
+                selectBook(m_selectedBookIndex - 1);
             }
             else if (m_currentBookPage > 0)
             {
                 // Move to previous page
                 previousBookPage();
                 m_selectedBookIndex = m_availableBooks.size() - 1; // Select last book on previous page
-                draw(EinkDisplayManager::UPDATE_FULL);
+                draw(EinkDisplayManager::UPDATE_FAST);
             }
         }
         break;
@@ -242,7 +304,7 @@ void BookScreen::handleBackAction()
         closeBook();
         setMode(MODE_BOOK_LIST);
         display.wipeScreen();
-        draw(EinkDisplayManager::UPDATE_FULL);
+        draw(EinkDisplayManager::UPDATE_PARTIAL);
         break;
 
     case MODE_BOOK_LIST:
@@ -269,49 +331,41 @@ bool BookScreen::loadBook(const String &filepath)
         return false;
     }
 
+    // The reader paginates the book itself, an upload's pre-pagination would only compete
+    m_ingestPaginator.stop();
+
     m_currentBookInfo.filename = filepath;
     m_currentBookInfo.format = detectBookFormat(filepath);
     m_currentBookInfo.fileSize = getFileSize(filepath);
 
-    // Check if file is too large for available memory
-    if (m_currentBookInfo.fileSize > freeHeap / 3)
-    {
-        Serial.println("File too large for available memory: " + String(m_currentBookInfo.fileSize) + " bytes");
-        return false;
-    }
+    // Display geometry is only reliable once the display is up, not at construction
+    configureLayout();
 
-    bool success = false;
-    switch (m_currentBookInfo.format)
+    if (m_currentBookInfo.format == FORMAT_UNKNOWN)
     {
-    case FORMAT_TXT:
-        success = loadTxtBook(filepath);
-        break;
-    case FORMAT_EPUB:
-        success = loadEpubBook(filepath);
-        break;
-    default:
         Serial.println("Unsupported book format");
         return false;
     }
 
+    bool success = loadCompactBook(filepath);
+
     if (success)
     {
         m_bookLoaded = true;
-        m_pageInfo.currentPage = 0;
 
-        // Show pagination progress
-        display.wipeScreen();
-        display.m_display.setFont(&FreeMono9pt7b);
-        display.drawCenteredText("Processing book...", 150, &FreeMono9pt7b);
-        display.m_display.setFont(&FreeMono9pt7b);
-        display.drawCenteredText("Creating pages", 170, &FreeMono9pt7b);
-        display.update(EinkDisplayManager::UPDATE_FULL);
+        // Resume where the book was left, whatever layout was used back then
+        uint32_t resumeOffset = 0;
+        if (ReadingPositions::load(filepath, m_currentBookInfo.fileSize, resumeOffset))
+        {
+            Serial.println("Resuming at offset " + String(resumeOffset));
+        }
+        m_savedPosition = resumeOffset;
 
-        paginateContent();
+        buildPages(resumeOffset);
 
-        // Check memory after pagination
+        // Check memory once the book is open; pagination may still be running
         size_t freeHeapAfter = ESP.getFreeHeap();
-        Serial.println("Free heap after pagination: " + String(freeHeapAfter) + " bytes");
+        Serial.println("Free heap after opening book: " + String(freeHeapAfter) + " bytes");
 
         // Extract title from filename if not set
         if (m_currentBookInfo.title.isEmpty())
@@ -329,7 +383,7 @@ bool BookScreen::loadBook(const String &filepath)
         }
 
         Serial.println("Book loaded successfully: " + m_currentBookInfo.title);
-        Serial.println("Total pages: " + String(m_pageInfo.totalPages));
+        Serial.println("Pages ready: " + String(m_paginator.pageCount()) + (m_paginator.isComplete() ? "" : " (paginating)"));
         Serial.println("Memory used for book: " + String(freeHeap - freeHeapAfter) + " bytes");
     }
 
@@ -338,17 +392,23 @@ bool BookScreen::loadBook(const String &filepath)
 
 void BookScreen::closeBook()
 {
+    saveReadingPosition();
+    m_cover.close();
     m_bookLoaded = false;
 
-    // Clear content and free memory
-    m_bookContent = "";
+    // Close the text stream and free the page table
+    m_stream.close();
 
-    m_pages.clear();
-    // Free unused memory by swapping with empty vector
-    std::vector<String>().swap(m_pages);
+    // Stops a pagination task that may still be running
+    m_paginator.clear();
+    m_pageCache.clear();
+    releasePrerenderedPages();
+    m_chapters.clear();
 
     m_pageInfo.currentPage = 0;
     m_pageInfo.totalPages = 0;
+    m_pageInfo.startPosition = 0;
+    m_pageInfo.endPosition = 0;
     m_currentBookInfo = BookInfo();
 
     Serial.println("Book closed and memory freed");
@@ -361,37 +421,147 @@ bool BookScreen::isBookLoaded() const
 
 bool BookScreen::nextPage()
 {
-    if (!m_bookLoaded || m_pageInfo.currentPage >= m_pageInfo.totalPages - 1)
+    // The next page starts where this one ends, no page table needed
+    uint32_t next;
+    if (!m_bookLoaded || !getNextPageStart(next))
     {
         return false;
     }
 
-    m_pageInfo.currentPage++;
+    setPagePosition(next);
     return true;
 }
 
 bool BookScreen::previousPage()
 {
-    if (!m_bookLoaded || m_pageInfo.currentPage <= 0)
+    uint32_t previous;
+    if (!m_bookLoaded || !getPreviousPageStart(previous))
     {
         return false;
     }
 
-    m_pageInfo.currentPage--;
+    setPagePosition(previous);
     return true;
 }
 
 bool BookScreen::goToPage(int pageNumber)
 {
-    if (!m_bookLoaded || pageNumber < 0 || pageNumber >= m_pageInfo.totalPages)
+    // Only published pages can be opened by number; goToOffset reaches the rest
+    PageSpan span;
+    if (!m_bookLoaded || !m_paginator.getPage(pageNumber, span))
     {
         return false;
     }
 
-    m_pageInfo.currentPage = pageNumber;
+    setPagePosition(span.offset);
+    return true;
+}
+
+bool BookScreen::goToOffset(uint32_t offset)
+{
+    if (!m_bookLoaded || offset >= m_stream.size())
+    {
+        return false;
+    }
+
+    // Positions pagination has reached are shown at the start of the page holding them
+    PageSpan span;
+    int page = m_paginator.findPage(offset);
+    if (page >= 0 && m_paginator.getPage(page, span))
+    {
+        setPagePosition(span.offset);
+        return true;
+    }
+
+    // Further on, the page is laid out from the sentence holding the offset,
+    // as after a font change, rather than waiting for the table to get there
+    uint32_t anchor = m_layout.sentenceStart(m_stream, offset, SENTENCE_LOOKBACK);
+    int lineCount = 0;
+    if (m_layout.layoutPage(m_stream, anchor, nullptr, lineCount) <= offset)
+    {
+        anchor = offset;
+    }
+    anchor = m_layout.skipBlank(m_stream, anchor);
+    if (anchor >= m_stream.size())
+    {
+        return false;
+    }
+    setPagePosition(anchor);
     return true;
 }
 
+bool BookScreen::nextChapter()
+{
+    // First chapter starting after the current page
+    for (uint32_t start : m_chapters)
+    {
+        if (start >= m_pageInfo.endPosition)
+        {
+            return goToOffset(m_layout.skipBlank(m_stream, start));
+        }
+    }
+    return false;
+}
+
+int BookScreen::searchBook(const String &query, std::vector<SearchHit> &hits, int maxHits)
+{
+    hits.clear();
+
+    BookSearch search;
+    if (!m_bookLoaded || !search.setPattern(query))
+    {
+        return 0;
+    }
+
+    SearchStats stats;
+    search.scan(m_stream.path(), 0, 0, [&](uint32_t offset)
+                {
+        SearchHit hit = {offset, m_paginator.findPage(offset)};
+        hits.push_back(hit);
+        return (int)hits.size() < maxHits; }, stats);
+
+    Serial.println("Search \"" + query + "\": " + String(stats.hits) + " hits, " + String(stats.bytesScanned) +
+                   " bytes in " + String(stats.elapsedMs) + "ms (" + String(stats.kilobytesPerSecond()) + " KB/s)");
+    return hits.size();
+}
+
+bool BookScreen::findNext(const String &query)
+{
+    BookSearch search;
+    if (!m_bookLoaded || !search.setPattern(query))
+    {
+        return false;
+    }
+    m_searchQuery = query;
+
+    // First match after the current page, wrapping around to the beginning
+    bool found = false;
+    uint32_t match = 0;
+    auto onHit = [&](uint32_t offset)
+    {
+        found = true;
+        match = offset;
+        return false;
+    };
+
+    SearchStats stats;
+    search.scan(m_stream.path(), m_pageInfo.endPosition, 0, onHit, stats);
+    uint32_t scanned = stats.bytesScanned;
+    uint32_t elapsed = stats.elapsedMs;
+    if (!found && m_pageInfo.startPosition > 0)
+    {
+        search.scan(m_stream.path(), 0, m_pageInfo.startPosition + search.patternLength(), onHit, stats);
+        scanned += stats.bytesScanned;
+        elapsed += stats.elapsedMs;
+    }
+
+    uint32_t throughput = elapsed ? (uint32_t)((uint64_t)scanned * 1000 / 1024 / elapsed) : 0;
+    Serial.println("Find \"" + query + "\": " + (found ? "match at " + String(match) : String("no match")) + ", " +
+                   String(scanned) + " bytes in " + String(elapsed) + "ms (" + String(throughput) + " KB/s)");
+
+    return found && goToOffset(match);
+}
+
 void BookScreen::increaseFontSize()
 {
     if (m_textSettings.font == &FreeMono9pt7b)
@@ -407,11 +577,7 @@ void BookScreen::increaseFontSize()
         m_textSettings.lineHeight = 24;
     }
 
-    m_textSettings.wordsPerPage = calculateWordsPerPage();
-    if (m_bookLoaded)
-    {
-        paginateContent(); // Re-paginate with new font size
-    }
+    applyTextSettings();
 }
 
 void BookScreen::decreaseFontSize()
@@ -429,21 +595,39 @@ void BookScreen::decreaseFontSize()
         m_textSettings.lineHeight = 14;
     }
 
-    m_textSettings.wordsPerPage = calculateWordsPerPage();
-    if (m_bookLoaded)
-    {
-        paginateContent(); // Re-paginate with new font size
-    }
+    applyTextSettings();
 }
 
 void BookScreen::setFont(const GFXfont *font)
 {
     m_textSettings.font = font;
+    applyTextSettings();
+}
+
+void BookScreen::applyTextSettings()
+{
     m_textSettings.wordsPerPage = calculateWordsPerPage();
-    if (m_bookLoaded)
+    configureLayout();
+    if (!m_bookLoaded)
     {
-        paginateContent();
+        return;
     }
+
+    // The new layout starts at the sentence that was at the top of the
+    // page, unless that sentence would push the old top off the new page
+    uint32_t current = m_pageInfo.startPosition;
+    uint32_t anchor = m_layout.sentenceStart(m_stream, current, SENTENCE_LOOKBACK);
+    int lineCount = 0;
+    if (m_layout.layoutPage(m_stream, anchor, nullptr, lineCount) <= current)
+    {
+        anchor = current;
+    }
+
+    // Only the page at the anchor is laid out now; the table is rebuilt in
+    // the background and neighbouring pages are laid out on demand
+    unsigned long startTime = micros();
+    buildPages(anchor);
+    Serial.println("Relayout at offset " + String(anchor) + " in " + String(micros() - startTime) + "us");
 }
 
 void BookScreen::showBookMenu()
@@ -456,6 +640,11 @@ void BookScreen::showBookMenu()
 
 void BookScreen::hideBookMenu()
 {
+    if (m_showingHits)
+    {
+        initializeBookMenu();
+        m_showingHits = false;
+    }
     m_bookMenu.isVisible = false;
     setMode(MODE_BOOK_READER);
     draw(EinkDisplayManager::UPDATE_PARTIAL);
@@ -463,6 +652,12 @@ void BookScreen::hideBookMenu()
 
 void BookScreen::handleBookMenuSelect()
 {
+    if (m_showingHits)
+    {
+        handleSearchResultSelect();
+        return;
+    }
+
     if (m_bookMenu.selectedOption < m_bookMenu.options.size())
     {
         String selectedOption = m_bookMenu.options[m_bookMenu.selectedOption];
@@ -477,6 +672,22 @@ void BookScreen::handleBookMenuSelect()
             decreaseFontSize();
             draw(EinkDisplayManager::UPDATE_PARTIAL);
         }
+        else if (selectedOption == "Next Chapter")
+        {
+            // A new chapter changes the whole page, so it gets the fast full refresh
+            nextChapter();
+            m_bookMenu.isVisible = false;
+            setMode(MODE_BOOK_READER);
+            draw(EinkDisplayManager::UPDATE_FAST);
+        }
+        else if (selectedOption == "Search Results")
+        {
+            showSearchResults();
+        }
+        else if (selectedOption == "Show Cover")
+        {
+            showCover();
+        }
         else if (selectedOption == "Return to Reading")
         {
             hideBookMenu();
@@ -488,6 +699,103 @@ void BookScreen::handleBookMenuSelect()
     }
 }
 
+bool BookScreen::showSearchResults()
+{
+    // There is no keyboard; queries come from the serial find command
+    if (m_searchQuery.length() == 0)
+    {
+        Serial.println("No search yet, send 'find <text>' over serial");
+        hideBookMenu();
+        return false;
+    }
+
+    std::vector<SearchHit> hits;
+    searchBook(m_searchQuery, hits);
+
+    // One entry per page, the first SEARCH_MENU_HITS pages with a match
+    m_searchHits.clear();
+    m_bookMenu.options.clear();
+    for (const SearchHit &hit : hits)
+    {
+        if (!m_searchHits.empty() && hit.page >= 0 && hit.page == m_searchHits.back().page)
+        {
+            continue;
+        }
+        if (m_searchHits.size() >= SEARCH_MENU_HITS)
+        {
+            break;
+        }
+        m_searchHits.push_back(hit);
+
+        // Pages past the paginated part are given as a share of the book
+        m_bookMenu.options.push_back(hit.page >= 0 ? "Page " + String(hit.page + 1)
+                                                   : String((uint64_t)hit.offset * 100 / m_stream.size()) + "%");
+    }
+    m_bookMenu.options.push_back(m_searchHits.empty() ? "No matches" : "Back");
+    m_bookMenu.title = "Search: " + m_searchQuery;
+    m_bookMenu.selectedOption = 0;
+    m_showingHits = true;
+    draw(EinkDisplayManager::UPDATE_PARTIAL);
+    return !m_searchHits.empty();
+}
+
+void BookScreen::handleSearchResultSelect()
+{
+    int index = m_bookMenu.selectedOption;
+    initializeBookMenu();
+    m_showingHits = false;
+
+    // The entry after the hits goes back to the reading menu
+    if (index >= (int)m_searchHits.size())
+    {
+        m_bookMenu.isVisible = true;
+        draw(EinkDisplayManager::UPDATE_PARTIAL);
+        return;
+    }
+
+    goToOffset(m_searchHits[index].offset);
+    setMode(MODE_BOOK_READER);
+    draw(EinkDisplayManager::UPDATE_PARTIAL);
+}
+
+bool BookScreen::showCover()
+{
+    String path = m_currentBookInfo.filename;
+    int dot = path.lastIndexOf('.');
+    if (dot > path.lastIndexOf('/'))
+    {
+        path = path.substring(0, dot);
+    }
+    path += ".bmp";
+
+    m_bookMenu.isVisible = false;
+    setMode(MODE_BOOK_READER);
+    if (!fileExists(path) || !m_cover.open(path))
+    {
+        Serial.println("No cover image at " + path);
+        draw(EinkDisplayManager::UPDATE_PARTIAL);
+        return false;
+    }
+
+    // Covers use the four gray levels; the reader can compare the others in Files
+    m_cover.setDitherMode(GrayDither::KERNEL_DIFFUSION, 4);
+    display.wipeScreen();
+    draw(EinkDisplayManager::UPDATE_FULL);
+    return true;
+}
+
+bool BookScreen::closeCover()
+{
+    if (!m_cover.isOpen())
+    {
+        return false;
+    }
+    m_cover.close();
+    display.wipeScreen();
+    draw(EinkDisplayManager::UPDATE_PARTIAL);
+    return true;
+}
+
 BookScreen::ScreenMode BookScreen::getCurrentMode() const
 {
     return m_currentMode;
@@ -561,7 +869,9 @@ BookInfo BookScreen::getBookInfo() const
 
 PageInfo BookScreen::getPageInfo() const
 {
-    return m_pageInfo;
+    PageInfo info = m_pageInfo;
+    info.totalPages = m_paginator.isComplete() ? m_paginator.pageCount() : m_paginator.estimatedPageCount();
+    return info;
 }
 
 TextSettings BookScreen::getTextSettings() const
@@ -572,7 +882,6 @@ TextSettings BookScreen::getTextSettings() const
 std::vector<BookInfo> BookScreen::scanBooksDirectory()
 {
     std::vector<BookInfo> books;
-    std::vector<BookInfo> allBooks;
 
     // Check if SD card is available
     if (getSDCardStatus() != SD_READY)
@@ -587,51 +896,17 @@ std::vector<BookInfo> BookScreen::scanBooksDirectory()
         return books;
     }
 
-    File dir = SD.open("/books");
-    if (!dir)
+    // The catalog only walks the directory when it is missing or stale
+    if (!m_catalog.open("/books"))
     {
-        Serial.println("Failed to open books directory on SD card");
+        Serial.println("Failed to open library catalog");
         return books;
     }
 
-    // First pass: count all books and collect basic info
-    File file = dir.openNextFile();
-    while (file)
-    {
-        if (!file.isDirectory())
-        {
-            String filename = String(file.name());
-            String fullPath = "/books/" + filename;
-
-            BookFormat format = detectBookFormat(filename);
-            if (format != FORMAT_UNKNOWN)
-            {
-                BookInfo book;
-                book.filename = fullPath;
-                book.format = format;
-                book.fileSize = file.size();
-                book.isValid = true;
-
-                // Extract title from filename
-                int lastDot = filename.lastIndexOf('.');
-                if (lastDot > 0)
-                {
-                    book.title = filename.substring(0, lastDot);
-                }
-                else
-                {
-                    book.title = filename;
-                }
-
-                allBooks.push_back(book);
-            }
-        }
-        file = dir.openNextFile();
-    }
-    dir.close();
+    int bookCount = m_catalog.count();
 
     // Calculate pagination
-    this->m_totalBookPages = (allBooks.size() + this->m_booksPerPage - 1) / this->m_booksPerPage;
+    this->m_totalBookPages = (bookCount + this->m_booksPerPage - 1) / this->m_booksPerPage;
     if (this->m_totalBookPages == 0)
         this->m_totalBookPages = 1;
 
@@ -645,17 +920,20 @@ std::vector<BookInfo> BookScreen::scanBooksDirectory()
         this->m_currentBookPage = 0;
     }
 
-    // Get books for current page
+    // Read only the records for the current page
     int startIndex = this->m_currentBookPage * this->m_booksPerPage;
-    int endIndex = std::min(startIndex + this->m_booksPerPage, (int)allBooks.size());
+    int endIndex = std::min(startIndex + this->m_booksPerPage, bookCount);
 
     for (int i = startIndex; i < endIndex; i++)
     {
-        books.push_back(allBooks[i]);
-        Serial.println("Loaded book: " + allBooks[i].title + " (" + String(allBooks[i].fileSize) + " bytes)");
+        BookInfo book;
+        if (m_catalog.read(i, book))
+        {
+            books.push_back(book);
+        }
     }
 
-    Serial.println("Page " + String(this->m_currentBookPage + 1) + "/" + String(this->m_totalBookPages) + ", showing " + String(books.size()) + " of " + String(allBooks.size()) + " books");
+    Serial.println("Page " + String(this->m_currentBookPage + 1) + "/" + String(this->m_totalBookPages) + ", showing " + String(books.size()) + " of " + String(bookCount) + " books");
     return books;
 }
 
@@ -678,10 +956,7 @@ BookFormat BookScreen::detectBookFormat(const String &filename)
 
 void BookScreen::drawHeader()
 {
-    // Draw status bar first
-    extern void drawStatusBar();
-    drawStatusBar();
-
+    // The status bar is a display layer, endDrawing() paints it over the header
     // Draw screen title based on mode
     display.m_display.setFont(&FreeMono12pt7b);
     switch (m_currentMode)
@@ -732,61 +1007,16 @@ void BookScreen::drawBookListContent()
     else
     {
         // Display book list
-        int startY = 80;
-        int lineHeight = 25;
-        int availableHeight = display.m_display.height() - startY - 40;
-        int maxVisible = availableHeight / lineHeight;
-
-        // Calculate scroll offset
-        int scrollOffset = 0;
-        if (this->m_selectedBookIndex >= maxVisible)
-        {
-            scrollOffset = this->m_selectedBookIndex - maxVisible + 1;
-        }
+        int maxVisible = bookListVisibleRows();
+        int scrollOffset = bookListScrollOffset();
 
-        for (int i = 0; i < std::min((int)this->m_availableBooks.size(), maxVisible); i++)
+        for (int i = 0; i < maxVisible; i++)
         {
             int bookIndex = i + scrollOffset;
             if (bookIndex >= this->m_availableBooks.size())
                 break;
 
-            const BookInfo &book = this->m_availableBooks[bookIndex];
-            int y = startY + (i * lineHeight);
-
-            // Highlight selected book
-            if (bookIndex == this->m_selectedBookIndex)
-            {
-                display.m_display.fillRect(5, y - 18, display.m_display.width() - 10, lineHeight, GxEPD_BLACK);
-                display.m_display.setTextColor(GxEPD_WHITE);
-            }
-            else
-            {
-                display.m_display.setTextColor(GxEPD_BLACK);
-            }
-
-            // Draw book title without icon
-            display.m_display.setFont(&FreeMono9pt7b);
-
-            // Truncate title if too long
-            String displayTitle = book.title;
-            if (displayTitle.length() > 25)
-            {
-                displayTitle = displayTitle.substring(0, 22) + "...";
-            }
-
-            display.m_display.setCursor(10, y);
-            display.m_display.print(displayTitle);
-
-            // Draw file size (right-aligned)
-            String sizeStr = formatFileSize(book.fileSize);
-            int16_t x1, y1;
-            uint16_t w, h;
-            display.m_display.getTextBounds(sizeStr.c_str(), 0, 0, &x1, &y1, &w, &h);
-            display.m_display.setCursor(display.m_display.width() - w - 10, y);
-            display.m_display.print(sizeStr);
-
-            // Reset text color
-            display.m_display.setTextColor(GxEPD_BLACK);
+            drawBookListRow(bookIndex, BOOK_LIST_TOP + (i * BOOK_LIST_LINE_HEIGHT));
         }
 
         // Draw pagination info at bottom if multiple pages
@@ -803,132 +1033,196 @@ void BookScreen::drawBookListContent()
     }
 }
 
-void BookScreen::drawBookReaderContent()
+int BookScreen::bookListVisibleRows() const
+{
+    int availableHeight = display.m_display.height() - BOOK_LIST_TOP - 40;
+    return availableHeight / BOOK_LIST_LINE_HEIGHT;
+}
+
+int BookScreen::bookListScrollOffset() const
 {
-    if (!this->m_bookLoaded || this->m_pages.empty())
+    int maxVisible = bookListVisibleRows();
+    if (this->m_selectedBookIndex >= maxVisible)
     {
-        display.m_display.setFont(&FreeMono12pt7b);
-        display.drawCenteredText("No book loaded", 200, &FreeMono12pt7b);
-        return;
+        return this->m_selectedBookIndex - maxVisible + 1;
     }
+    return 0;
+}
 
-    // Draw book title and page info in header area
+void BookScreen::drawBookListRow(int bookIndex, int y)
+{
+    const BookInfo &book = this->m_availableBooks[bookIndex];
+
+    // Highlight selected book
+    if (bookIndex == this->m_selectedBookIndex)
+    {
+        display.m_display.fillRect(5, y - 18, display.m_display.width() - 10, BOOK_LIST_LINE_HEIGHT, GxEPD_BLACK);
+        display.m_display.setTextColor(GxEPD_WHITE);
+    }
+    else
+    {
+        display.m_display.setTextColor(GxEPD_BLACK);
+    }
+
+    // Draw book title without icon
     display.m_display.setFont(&FreeMono9pt7b);
 
-    // Book title (truncated if too long)
-    String title = this->m_currentBookInfo.title;
-    if (title.length() > 20)
+    // Truncate title if too long
+    String displayTitle = book.title;
+    if (displayTitle.length() > 25)
     {
-        title = title.substring(0, 17) + "...";
+        displayTitle = displayTitle.substring(0, 22) + "...";
     }
-    display.m_display.setCursor(5, 16);
-    display.m_display.print(title);
 
-    // Page info
-    String pageInfo = String(this->m_pageInfo.currentPage + 1) + "/" + String(this->m_pageInfo.totalPages);
+    display.m_display.setCursor(10, y);
+    display.m_display.print(displayTitle);
+
+    // Draw file size (right-aligned)
+    String sizeStr = formatFileSize(book.fileSize);
     int16_t x1, y1;
     uint16_t w, h;
-    display.m_display.getTextBounds(pageInfo.c_str(), 0, 0, &x1, &y1, &w, &h);
-    display.m_display.setCursor(display.m_display.width() - w - 5, 16);
-    display.m_display.print(pageInfo);
+    display.m_display.getTextBounds(sizeStr.c_str(), 0, 0, &x1, &y1, &w, &h);
+    display.m_display.setCursor(display.m_display.width() - w - 10, y);
+    display.m_display.print(sizeStr);
 
-    // Separator line
-    display.m_display.drawLine(0, 25, display.m_display.width(), 25, GxEPD_BLACK);
+    // Reset text color
+    display.m_display.setTextColor(GxEPD_BLACK);
+}
 
-    // Draw book content
-    display.m_display.setFont(m_textSettings.font);
+void BookScreen::selectBook(int index)
+{
+    int previous = m_selectedBookIndex;
+    int previousOffset = bookListScrollOffset();
+    m_selectedBookIndex = index;
 
-    if (m_pageInfo.currentPage < m_pages.size())
+    // When the list does not scroll only the two rows whose highlight changed
+    // are redrawn, so the refresh covers just those windows
+    if (m_isLoading || bookListScrollOffset() != previousOffset)
     {
-        String currentPageContent = m_pages[m_pageInfo.currentPage];
-
-        // Optimized text rendering with pre-calculated line width
-        int yPos = 45;
-        int xPos = m_textSettings.margin;
-        int maxLineWidth = display.m_display.width() - (m_textSettings.margin * 2);
-        int maxY = display.m_display.height() - 30;
+        draw(EinkDisplayManager::UPDATE_PARTIAL);
+        return;
+    }
 
-        // Estimate characters per line for faster word wrapping
-        int approxCharsPerLine = maxLineWidth / 8; // Approximate character width
+    int rows[2] = {previous, index};
+    for (int bookIndex : rows)
+    {
+        int y = BOOK_LIST_TOP + (bookIndex - previousOffset) * BOOK_LIST_LINE_HEIGHT;
+        display.startDrawing(0, y - 18, display.m_display.width(), BOOK_LIST_LINE_HEIGHT);
+        drawBookListRow(bookIndex, y);
+    }
+    display.endDrawing();
+    display.update(EinkDisplayManager::UPDATE_PARTIAL);
+}
 
-        String currentLine = "";
-        currentLine.reserve(approxCharsPerLine + 20); // Pre-allocate
+void BookScreen::drawBookReaderContent()
+{
+#ifdef READER_TIMING
+    unsigned long layoutStart = micros();
+#endif
+    const PageLines *page = this->m_bookLoaded ? getPageLines(m_pageInfo.startPosition) : nullptr;
+#ifdef READER_TIMING
+    unsigned long renderStart = micros();
+#endif
 
-        int contentLength = currentPageContent.length();
-        int i = 0;
+    if (!page)
+    {
+        display.m_display.setFont(&FreeMono12pt7b);
+        display.drawCenteredText("No book loaded", 200, &FreeMono12pt7b);
+        return;
+    }
 
-        while (i < contentLength && yPos <= maxY)
-        {
-            // Find next word boundary
-            int wordStart = i;
-            while (i < contentLength && currentPageContent.charAt(i) != ' ' && currentPageContent.charAt(i) != '\n')
-            {
-                i++;
-            }
+    drawReaderTitle();
 
-            String word = currentPageContent.substring(wordStart, i);
-            bool isNewline = (i < contentLength && currentPageContent.charAt(i) == '\n');
+    // Line breaks come from the page's cached table; glyphs are blitted
+    // straight into the frame, which the dirty tracker cannot see, so the
+    // text block is marked by hand
+    m_layout.drawLines(m_blitter, display.m_display, m_stream, page->lines, page->lineCount, GxEPD_BLACK);
+    int16_t ascent = m_layout.metrics().yAdvance();
+    display.m_display.markDirty(0, m_layout.top() - ascent, display.m_display.width(),
+                                page->lineCount * m_layout.lineHeight() + ascent);
 
-            // Quick length check before expensive getTextBounds
-            String testLine = currentLine + (currentLine.isEmpty() ? "" : " ") + word;
-            bool needNewLine = isNewline || testLine.length() > approxCharsPerLine;
+#ifdef READER_TIMING
+    // Page-turn CPU cost, excluding the panel refresh
+    unsigned long renderEnd = micros();
+    Serial.printf("Page at %u layout %luus, render %luus\n", (unsigned)m_pageInfo.startPosition, renderStart - layoutStart,
+                  renderEnd - renderStart);
+#endif
+}
 
-            // Only use getTextBounds if quick check suggests we might exceed width
-            if (needNewLine && testLine.length() > approxCharsPerLine * 0.8)
-            {
-                int16_t x1, y1;
-                uint16_t w, h;
-                display.m_display.getTextBounds(testLine.c_str(), 0, 0, &x1, &y1, &w, &h);
-                needNewLine = (w > maxLineWidth) || isNewline;
-            }
+void BookScreen::drawReaderTitle()
+{
+    // Draw book title and page info in header area
+    display.m_display.setFont(&FreeMono9pt7b);
 
-            if (needNewLine)
-            {
-                // Draw current line
-                if (!currentLine.isEmpty())
-                {
-                    display.m_display.setCursor(xPos, yPos);
-                    display.m_display.print(currentLine);
-                    yPos += m_textSettings.lineHeight;
-                    currentLine = "";
-                }
+    // Book title (truncated if too long); the header is formatted into stack
+    // buffers so drawing a page does not touch the heap
+    const String &fullTitle = this->m_currentBookInfo.title;
+    char title[24];
+    snprintf(title, sizeof(title), fullTitle.length() > 20 ? "%.17s..." : "%s", fullTitle.c_str());
+    display.m_display.setCursor(5, 16);
+    display.m_display.print(title);
 
-                if (!isNewline && yPos <= maxY)
-                {
-                    currentLine = word;
-                }
-            }
-            else
-            {
-                currentLine = testLine;
-            }
+    // Page info, right-aligned using the font's advance table. While the
+    // book is still being paginated the total is an estimate, shown as "~340",
+    // and so is the page number until pagination reaches a resumed position.
+    // If pagination failed the total is unknown and shown as "err"
+    m_pageInfo.currentPage = m_paginator.findPage(m_pageInfo.startPosition);
+    m_pageInfo.totalPages = m_paginator.pageCount();
+    int estimatedTotal = m_paginator.estimatedPageCount();
 
-            // Skip the space or newline character
-            if (i < contentLength)
-            {
-                i++;
-            }
-        }
+    char pageInfo[24];
+    int length;
+    if (m_pageInfo.currentPage >= 0)
+    {
+        length = snprintf(pageInfo, sizeof(pageInfo), "%d/", this->m_pageInfo.currentPage + 1);
+    }
+    else if (m_paginator.hasFailed())
+    {
+        length = snprintf(pageInfo, sizeof(pageInfo), "?/");
+    }
+    else
+    {
+        size_t size = max(m_stream.size(), (size_t)1);
+        length = snprintf(pageInfo, sizeof(pageInfo), "~%d/", (int)((uint64_t)m_pageInfo.startPosition * estimatedTotal / size) + 1);
+    }
 
-        // Draw remaining line
-        if (!currentLine.isEmpty() && yPos <= maxY)
-        {
-            display.m_display.setCursor(xPos, yPos);
-            display.m_display.print(currentLine);
-        }
+    if (m_paginator.hasFailed())
+    {
+        length += snprintf(pageInfo + length, sizeof(pageInfo) - length, "err");
     }
+    else if (m_paginator.isComplete())
+    {
+        length += snprintf(pageInfo + length, sizeof(pageInfo) - length, "%d", this->m_pageInfo.totalPages);
+    }
+    else
+    {
+        length += snprintf(pageInfo + length, sizeof(pageInfo) - length, "~%d", estimatedTotal);
+    }
+    uint16_t w = FontMetrics::forFont(&FreeMono9pt7b).measure(pageInfo, length);
+    display.m_display.setCursor(display.m_display.width() - w - 5, 16);
+    display.m_display.print(pageInfo);
+
+    // Separator line
+    display.m_display.drawLine(0, 25, display.m_display.width(), 25, GxEPD_BLACK);
 }
 
 void BookScreen::drawBookMenuDialog()
 {
     // Draw semi-transparent background
-    display.m_display.fillRect(20, 80, display.m_display.width() - 40, 200, GxEPD_WHITE);
-    display.m_display.drawRect(20, 80, display.m_display.width() - 40, 200, GxEPD_BLACK);
+    display.m_display.fillRect(20, 80, display.m_display.width() - 40, 220, GxEPD_WHITE);
+    display.m_display.drawRect(20, 80, display.m_display.width() - 40, 220, GxEPD_BLACK);
+
+    // Title above a rule; a long search query is cut to the box width
+    char title[24];
+    snprintf(title, sizeof(title), m_bookMenu.title.length() > 18 ? "%.15s..." : "%s", m_bookMenu.title.c_str());
+    display.m_display.setTextColor(GxEPD_BLACK);
+    display.drawCenteredText(title, 98, &FreeMono9pt7b);
+    display.m_display.drawFastHLine(20, 104, display.m_display.width() - 40, GxEPD_BLACK);
 
     display.m_display.setFont(&FreeMono12pt7b);
 
     // Menu options
-    int yPos = 110;
+    int yPos = 126;
     int lineHeight = 25;
 
     for (int i = 0; i < m_bookMenu.options.size(); i++)
@@ -964,7 +1258,7 @@ void BookScreen::drawStatusBar()
     // This will be handled by the main status bar function
 }
 
-bool BookScreen::loadTxtBook(const String &filepath)
+bool BookScreen::loadCompactBook(const String &filepath)
 {
     // Check if SD card is ready
     if (getSDCardStatus() != SD_READY)
@@ -973,245 +1267,155 @@ bool BookScreen::loadTxtBook(const String &filepath)
         return false;
     }
 
-    File file = SD.open(filepath);
-    if (!file)
+    // Books are normally ingested at upload time, in which case this is a
+    // header read; anything copied onto the card otherwise is converted here
+    CompactBook book;
+    if (!BookIngest::ingest(filepath) || !BookIngest::open(filepath, book))
     {
-        Serial.println("Failed to open TXT file: " + filepath);
+        Serial.println("Failed to prepare book: " + filepath);
         return false;
     }
 
-    // Read file in smaller chunks to prevent memory issues
-    m_bookContent = "";
-
-    // Don't pre-allocate for very large files to avoid memory overflow
-    size_t fileSize = file.size();
-    if (fileSize < 50000) // Only pre-allocate for smaller files
-    {
-        m_bookContent.reserve(fileSize);
-    }
-
-    const size_t CHUNK_SIZE = 128; // Smaller chunks to prevent crashes
-    char buffer[CHUNK_SIZE + 1];
-    size_t totalRead = 0;
-
-    while (file.available())
+    // Text is streamed from the card through a small window, never loaded whole
+    if (!m_stream.open(book.textPath) || m_stream.size() == 0)
     {
-        size_t bytesRead = file.readBytes(buffer, CHUNK_SIZE);
-        buffer[bytesRead] = '\0';
-        m_bookContent += buffer;
-        totalRead += bytesRead;
-
-        // Yield more frequently to prevent watchdog timeout
-        if (totalRead % 512 == 0)
-        {
-            yield();
-            Serial.print("."); // Progress indicator
-        }
-
-        // Safety check for very large files
-        if (totalRead > 200000) // Limit to ~200KB
-        {
-            Serial.println("\nFile too large, truncating at 200KB");
-            break;
-        }
-    }
-    file.close();
-
-    if (m_bookContent.isEmpty())
-    {
-        Serial.println("Failed to read TXT file");
+        Serial.println("Failed to open book text: " + book.textPath);
+        m_stream.close();
         return false;
     }
 
-    Serial.println("Loaded TXT book: " + String(m_bookContent.length()) + " characters");
+    m_chapters.swap(book.chapters);
+    Serial.println("Opened book: " + String(m_stream.size()) + " bytes, " + String(m_chapters.size()) + " chapters");
     m_currentBookInfo.isValid = true;
     return true;
 }
 
-bool BookScreen::loadEpubBook(const String &filepath)
+bool BookScreen::ingestBook(const String &filepath)
 {
-    // Check if SD card is ready
-    if (getSDCardStatus() != SD_READY)
+    if (!BookIngest::ingest(filepath))
     {
-        Serial.println("SD card not ready for reading");
         return false;
     }
 
-    File file = SD.open(filepath);
-    if (!file)
+    // Pre-paginate so the first open is an index read; a layout of its own
+    // keeps the reader's state untouched
+    PageIndexKey key = getPageIndexKey(filepath);
+    PageTable pages;
+    if (PageIndex::load(key, pages))
     {
-        Serial.println("Failed to open EPUB file: " + filepath);
-        return false;
+        return true;
     }
 
-    // Read file in smaller chunks to prevent memory issues
-    m_bookContent = "";
-
-    // Don't pre-allocate for very large files to avoid memory overflow
-    size_t fileSize = file.size();
-    if (fileSize < 50000) // Only pre-allocate for smaller files
-    {
-        m_bookContent.reserve(fileSize);
-    }
-
-    const size_t CHUNK_SIZE = 128; // Smaller chunks to prevent crashes
-    char buffer[CHUNK_SIZE + 1];
-    size_t totalRead = 0;
-
-    while (file.available())
-    {
-        size_t bytesRead = file.readBytes(buffer, CHUNK_SIZE);
-        buffer[bytesRead] = '\0';
-        m_bookContent += buffer;
-        totalRead += bytesRead;
+    CompactBook book;
+    TextLayout layout;
+    buildLayout(layout);
+    return BookIngest::open(filepath, book) && m_ingestPaginator.start(book.textPath, layout, key);
+}
 
-        // Yield more frequently to prevent watchdog timeout
-        if (totalRead % 512 == 0)
-        {
-            yield();
-            Serial.print("."); // Progress indicator
-        }
+PageIndexKey BookScreen::getPageIndexKey(const String &filepath)
+{
+    PageIndexKey key;
+    key.path = filepath;
+    key.fileSize = 0;
+    key.modifiedTime = 0;
+    key.fontSignature = PageIndex::fontSignature(m_textSettings.font);
+    key.margin = m_textSettings.margin;
+    key.lineHeight = m_textSettings.lineHeight;
+    key.pageWidth = display.m_display.width();
+    key.pageHeight = display.m_display.height();
+
+    File file = SD.open(filepath, FILE_READ);
+    if (file)
+    {
+        key.fileSize = file.size();
+        key.modifiedTime = (uint32_t)file.getLastWrite();
+        file.close();
+    }
+    return key;
+}
 
-        // Safety check for very large files
-        if (totalRead > 200000) // Limit to ~200KB
-        {
-            Serial.println("\nFile too large, truncating at 200KB");
-            break;
-        }
-    }
-    file.close();
+void BookScreen::buildPages(uint32_t anchor)
+{
+    PageIndexKey key = getPageIndexKey(m_currentBookInfo.filename);
+    m_pageCache.clear();
+    m_localPage.offset = PageLines::NO_PAGE;
+    invalidatePrerenderedPages();
 
-    if (m_bookContent.isEmpty())
+    // Pages never start on blank space, nor can a position lie past the end
+    if (anchor >= m_stream.size())
     {
-        Serial.println("Failed to read EPUB file");
-        return false;
+        anchor = 0;
     }
+    anchor = m_layout.skipBlank(m_stream, anchor);
 
-    // Basic HTML tag removal for EPUB content (optimized)
-    m_bookContent.replace("<p>", "\n\n");
-    m_bookContent.replace("</p>", "");
-    m_bookContent.replace("<br>", "\n");
-    m_bookContent.replace("<br/>", "\n");
-    m_bookContent.replace("<br />", "\n");
-
-    // Remove other common HTML tags (optimized)
-    int tagStart = 0;
-    while ((tagStart = m_bookContent.indexOf('<', tagStart)) >= 0)
+    // Reopening a book or returning to a known font is a single index read;
+    // the position then snaps to the start of the page holding it
+    PageTable pages;
+    if (PageIndex::load(key, pages))
     {
-        int tagEnd = m_bookContent.indexOf('>', tagStart);
-        if (tagEnd > tagStart)
-        {
-            m_bookContent.remove(tagStart, tagEnd - tagStart + 1);
-        }
-        else
-        {
-            tagStart++; // Move past this character if no closing >
-        }
+        m_paginator.adopt(pages);
 
-        // Yield periodically during tag removal
-        if (tagStart % 1000 == 0)
+        PageSpan span;
+        int page = m_paginator.findPage(anchor);
+        if (page >= 0 && m_paginator.getPage(page, span))
         {
-            yield();
+            anchor = span.offset;
         }
+        setPagePosition(anchor);
+        return;
     }
 
-    m_currentBookInfo.isValid = true;
-    return true;
+    // Otherwise the page at the anchor is laid out directly and shown while
+    // the table is built in the background
+    paginateContent(anchor);
+    setPagePosition(anchor);
 }
 
-void BookScreen::paginateContent()
+void BookScreen::paginateContent(uint32_t anchor)
 {
-    if (m_bookContent.isEmpty())
+    if (!m_stream.isOpen())
     {
         return;
     }
 
-    m_pages.clear();
-
-    // Reserve some space but not too much to avoid memory issues
-    int estimatedPages = (m_bookContent.length() / 1000) + 10;
-    if (estimatedPages < 100) // Only reserve for reasonable number of pages
+    // Pages are published as they are found; the finished table is saved to
+    // the page index by the task
+    if (!m_paginator.start(m_stream.path(), m_layout, getPageIndexKey(m_currentBookInfo.filename), anchor))
     {
-        m_pages.reserve(estimatedPages);
+        Serial.println("Failed to start background pagination");
     }
+}
 
-    // More conservative pagination for memory efficiency
-    int displayHeight = display.m_display.height() - 75; // Account for header and footer
-    int linesPerPage = displayHeight / m_textSettings.lineHeight;
-    int approxCharsPerLine = (display.m_display.width() - (m_textSettings.margin * 2)) / 8;
-    int charsPerPage = linesPerPage * approxCharsPerLine * 0.6; // More conservative estimate
+void BookScreen::setPagePosition(uint32_t offset)
+{
+    m_pageInfo.startPosition = offset;
+    m_pageInfo.currentPage = m_paginator.findPage(offset);
 
-    int contentLength = m_bookContent.length();
-    int currentPos = 0;
-    int pageCount = 0;
+    const PageLines *page = getPageLines(offset);
+    m_pageInfo.endPosition = page ? page->end : offset;
+}
 
-    while (currentPos < contentLength)
+void BookScreen::update()
+{
+    // Page turns only mark the position; it is written once the reader settles
+    if (m_bookLoaded && m_pageInfo.startPosition != m_savedPosition &&
+        millis() - m_positionChangedAt > POSITION_SAVE_DELAY)
     {
-        int endPos = std::min(currentPos + charsPerPage, contentLength);
-
-        // Find word boundary
-        if (endPos < contentLength)
-        {
-            // Look for space, newline, or punctuation
-            int bestBreak = endPos;
-            for (int j = endPos; j > currentPos + (charsPerPage * 0.7) && j > currentPos; j--)
-            {
-                char c = m_bookContent.charAt(j);
-                if (c == ' ' || c == '\n' || c == '.' || c == '!' || c == '?')
-                {
-                    bestBreak = j;
-                    break;
-                }
-            }
-            endPos = bestBreak;
-        }
-
-        String page = m_bookContent.substring(currentPos, endPos);
-        page.trim(); // Remove leading/trailing whitespace
-
-        if (!page.isEmpty())
-        {
-            m_pages.push_back(page);
-            pageCount++;
-        }
-
-        currentPos = endPos;
-
-        // Yield every few pages to prevent watchdog timeout
-        if (pageCount % 5 == 0)
-        {
-            yield();
-            Serial.print("p"); // Progress indicator for pagination
-        }
-
-        // Safety limit on number of pages
-        if (pageCount > 500)
-        {
-            Serial.println("\nToo many pages, limiting to 500");
-            break;
-        }
-
-        // Skip whitespace at the beginning of next page
-        while (currentPos < contentLength &&
-               (m_bookContent.charAt(currentPos) == ' ' || m_bookContent.charAt(currentPos) == '\n'))
-        {
-            currentPos++;
-        }
-
-        // Yield periodically during pagination
-        if (m_pages.size() % 10 == 0)
-        {
-            yield();
-        }
+        saveReadingPosition();
     }
+}
 
-    m_pageInfo.totalPages = m_pages.size();
-    if (m_pageInfo.totalPages > 0)
+void BookScreen::saveReadingPosition()
+{
+    if (!m_bookLoaded || m_pageInfo.startPosition == m_savedPosition)
     {
-        m_pageInfo.currentPage = 0;
+        return;
     }
 
-    Serial.println("Pagination complete: " + String(m_pageInfo.totalPages) + " pages");
+    if (ReadingPositions::save(m_currentBookInfo.filename, m_currentBookInfo.fileSize, m_pageInfo.startPosition))
+    {
+        m_savedPosition = m_pageInfo.startPosition;
+    }
 }
 
 void BookScreen::calculatePages()
@@ -1220,17 +1424,6 @@ void BookScreen::calculatePages()
     paginateContent();
 }
 
-String BookScreen::extractTextFromPage(const String &content, int startPos, int maxChars)
-{
-    if (startPos >= content.length())
-    {
-        return "";
-    }
-
-    int endPos = std::min(startPos + maxChars, (int)content.length());
-    return content.substring(startPos, endPos);
-}
-
 int BookScreen::calculateWordsPerPage()
 {
     // Calculate based on display size and font
@@ -1262,6 +1455,274 @@ void BookScreen::initializeTextSettings()
     m_textSettings.lineHeight = 18;
     m_textSettings.margin = 10;
     m_textSettings.wordsPerPage = calculateWordsPerPage();
+    configureLayout();
+}
+
+void BookScreen::configureLayout()
+{
+    buildLayout(m_layout);
+}
+
+void BookScreen::buildLayout(TextLayout &layout) const
+{
+    // Text area below the reader header, baselines from y=45 to 30px above the bottom
+    int width = display.m_display.width() - (m_textSettings.margin * 2);
+    int bottom = display.m_display.height() - 30;
+    layout.configure(m_textSettings.font, m_textSettings.margin, 45, width, bottom, m_textSettings.lineHeight);
+}
+
+const PageLines *BookScreen::getPageLines(uint32_t start)
+{
+    const PageLines *cached = m_pageCache.find(start);
+    if (cached)
+    {
+        return cached;
+    }
+
+    if (start >= m_stream.size())
+    {
+        return nullptr;
+    }
+
+    // The same layout that paginated the book decides the lines
+    PageLines &lines = m_pageCache.slotFor(start);
+    lines.end = m_layout.layoutPage(m_stream, start, lines.lines, lines.lineCount);
+
+    // The page before a resume anchor ends short, drop what belongs to the next page
+    PageSpan span;
+    int page = m_paginator.findPage(start);
+    if (page >= 0 && m_paginator.getPage(page, span) && span.offset == start)
+    {
+        clipPageLines(lines, start + span.length);
+    }
+    else if (m_localPage.offset == start)
+    {
+        clipPageLines(lines, start + m_localPage.length);
+    }
+    return &lines;
+}
+
+void BookScreen::clipPageLines(PageLines &lines, uint32_t end)
+{
+    if (end >= lines.end)
+    {
+        return;
+    }
+
+    char buffer[TextLayout::MAX_LINE_BYTES];
+    while (lines.lineCount > 0 && lines.lines[lines.lineCount - 1].start >= end)
+    {
+        lines.lineCount--;
+    }
+    if (lines.lineCount > 0)
+    {
+        LineSpan &last = lines.lines[lines.lineCount - 1];
+        last.length = min((uint32_t)last.length, end - last.start);
+        size_t length = m_stream.read(last.start, buffer, last.length);
+        last.width = m_layout.metrics().measure(buffer, length);
+    }
+    lines.end = end;
+}
+
+void BookScreen::prefetchPageLines()
+{
+    if (!m_bookLoaded)
+    {
+        return;
+    }
+
+    // Only pages already known are laid out, this never waits on pagination
+    uint32_t next = 0;
+    if (getNextPageStart(next))
+    {
+        getPageLines(next);
+    }
+    uint32_t previous = 0;
+    if (getPreviousPageStart(previous))
+    {
+        getPageLines(previous);
+    }
+
+    // Keep the current page most recently used so it is never the one evicted
+    m_pageCache.find(m_pageInfo.startPosition);
+}
+
+bool BookScreen::getNextPageStart(uint32_t &start)
+{
+    // A page laid out away from the table snaps back to it once pagination
+    // has passed it: the next table page begins inside this one, so no text is skipped
+    PageSpan span;
+    int index = m_paginator.findPage(m_pageInfo.startPosition);
+    if (index >= 0 && m_paginator.getPage(index, span) && span.offset != m_pageInfo.startPosition &&
+        m_paginator.getPage(index + 1, span))
+    {
+        start = span.offset;
+        return true;
+    }
+
+    const PageLines *page = getPageLines(m_pageInfo.startPosition);
+    if (!page)
+    {
+        return false;
+    }
+
+    start = m_layout.skipBlank(m_stream, page->end);
+    return start < m_stream.size();
+}
+
+bool BookScreen::getPreviousPageStart(uint32_t &start)
+{
+    uint32_t current = m_pageInfo.startPosition;
+    PageSpan span;
+    int page = m_paginator.findPage(current);
+    if (page >= 0 && m_paginator.getPage(page, span))
+    {
+        // A position inside a page of the table goes back to that page's start
+        if (span.offset == current && (page == 0 || !m_paginator.getPage(page - 1, span)))
+        {
+            return false;
+        }
+        start = span.offset;
+        return true;
+    }
+
+    // After a resume or font change the table may still be catching up, so
+    // the page before is laid out from a window just behind the position
+    if (current == 0)
+    {
+        return false;
+    }
+    start = m_layout.previousPageStart(m_stream, current);
+    if (start >= current)
+    {
+        return false;
+    }
+
+    // Like a table page before an anchor, it ends where the current one starts
+    if (m_localPage.offset != start)
+    {
+        m_localPage.offset = start;
+        m_localPage.length = current - start;
+        m_pageCache.forget(start);
+    }
+    return true;
+}
+
+bool BookScreen::showPrerenderedPage(EinkDisplayManager::DisplayUpdateMode mode)
+{
+    for (int i = 0; i < PRERENDER_SLOTS; i++)
+    {
+        PrerenderedPage &slot = m_prerendered[i];
+        if (!slot.frame || slot.start != m_pageInfo.startPosition)
+        {
+            continue;
+        }
+
+        // The ready frame becomes the screen; the frame given up may hold
+        // overlays, so it is re-rendered before being reused
+        display.m_display.swap(*slot.frame);
+        slot.start = PageLines::NO_PAGE;
+
+        // Clock, battery and the page estimate may have changed since rendering
+        display.m_display.fillRect(0, 0, display.m_display.width(), 26, GxEPD_WHITE);
+        drawHeader();
+        drawReaderTitle();
+
+        display.endDrawing();
+        display.update(mode);
+
+        m_positionChangedAt = millis();
+        prefetchPageLines();
+        prerenderPages();
+        return true;
+    }
+    return false;
+}
+
+void BookScreen::prerenderPages()
+{
+    if (!m_bookLoaded)
+    {
+        return;
+    }
+
+    uint32_t wanted[PRERENDER_SLOTS] = {PageLines::NO_PAGE, PageLines::NO_PAGE};
+    getNextPageStart(wanted[0]);
+    getPreviousPageStart(wanted[1]);
+
+    for (int w = 0; w < PRERENDER_SLOTS; w++)
+    {
+        uint32_t start = wanted[w];
+        if (start == PageLines::NO_PAGE)
+        {
+            continue;
+        }
+
+        // Pick a slot already holding the page, otherwise one holding neither neighbour
+        PrerenderedPage *target = nullptr;
+        for (int i = 0; i < PRERENDER_SLOTS && !target; i++)
+        {
+            if (m_prerendered[i].start == start)
+            {
+                target = &m_prerendered[i];
+            }
+        }
+        if (target && target->frame)
+        {
+            continue;
+        }
+        for (int i = 0; i < PRERENDER_SLOTS && !target; i++)
+        {
+            uint32_t held = m_prerendered[i].start;
+            if (held != wanted[0] && held != wanted[1])
+            {
+                target = &m_prerendered[i];
+            }
+        }
+        if (!target)
+        {
+            continue;
+        }
+
+        if (!target->frame)
+        {
+            target->frame = display.createFrame();
+            if (!target->frame)
+            {
+                // Without spare memory page turns simply draw on demand
+                return;
+            }
+        }
+
+        // Draw the page with the regular reader code into the off-screen frame
+        PageInfo shown = m_pageInfo;
+        display.m_display.swap(*target->frame);
+        display.m_display.fillScreen(GxEPD_WHITE);
+        m_pageInfo.startPosition = start;
+        drawHeader();
+        drawBookReaderContent();
+        m_pageInfo = shown;
+        display.m_display.swap(*target->frame);
+        target->start = start;
+    }
+}
+
+void BookScreen::invalidatePrerenderedPages()
+{
+    for (int i = 0; i < PRERENDER_SLOTS; i++)
+    {
+        m_prerendered[i].start = PageLines::NO_PAGE;
+    }
+}
+
+void BookScreen::releasePrerenderedPages()
+{
+    for (int i = 0; i < PRERENDER_SLOTS; i++)
+    {
+        delete m_prerendered[i].frame;
+        m_prerendered[i].frame = nullptr;
+        m_prerendered[i].start = PageLines::NO_PAGE;
+    }
 }
 
 void BookScreen::ensureValidBookSelection()
@@ -1293,6 +1754,9 @@ void BookScreen::initializeBookMenu()
     m_bookMenu.options.clear();
     m_bookMenu.options.push_back("Increase Font");
     m_bookMenu.options.push_back("Decrease Font");
+    m_bookMenu.options.push_back("Next Chapter");
+    m_bookMenu.options.push_back("Search Results");
+    m_bookMenu.options.push_back("Show Cover");
     m_bookMenu.options.push_back("Return to Reading");
     m_bookMenu.options.push_back("Close Book");
 }
@@ -3,6 +3,13 @@
 
 #include "../../../include/display.h"
 #include "../../../include/storage.h"
+#include "book_stream.h"
+#include "library_catalog.h"
+#include "page_cache.h"
+#include "page_index.h"
+#include "paginator.h"
+#include "text_layout.h"
+#include "../files/image_viewer.h"
 #include <vector>
 #include <FS.h>
 #include <SD.h>
@@ -46,6 +53,14 @@ struct PageInfo
     String content;
 };
 
+// Search match: byte offset in the book text and the page holding it
+// (-1 while pagination has not reached it)
+struct SearchHit
+{
+    uint32_t offset;
+    int page;
+};
+
 // Book menu dialog structure
 struct BookMenuDialog
 {
@@ -77,10 +92,26 @@ public:
     void closeBook();
     bool isBookLoaded() const;
 
+    // Reading positions are saved when a book is closed, before sleep and
+    // once the reader has stayed on a page for POSITION_SAVE_DELAY
+    void update();
+    void saveReadingPosition();
+
+    // Convert a book and start paginating it in the background for the
+    // reader's layout, ahead of its first open. Leaves the open book alone
+    bool ingestBook(const String &filepath);
+    bool isIngesting() const { return m_ingestPaginator.isRunning(); }
+
     // Navigation
     bool nextPage();
     bool previousPage();
     bool goToPage(int pageNumber);
+    bool goToOffset(uint32_t offset);
+    bool nextChapter();
+
+    // Search
+    int searchBook(const String &query, std::vector<SearchHit> &hits, int maxHits = 50);
+    bool findNext(const String &query); // Jump to the next match after the current page, remembers the query
 
     // Text settings
     void increaseFontSize();
@@ -92,6 +123,10 @@ public:
     void hideBookMenu();
     void handleBookMenuSelect();
 
+    // Cover of the open book: a BMP next to it with the same name
+    bool showCover();
+    bool closeCover(); // True when a cover was open
+
     // State management
     enum ScreenMode {
         MODE_BOOK_LIST,
@@ -134,15 +169,48 @@ private:
     int m_currentBookPage;
     int m_booksPerPage;
     int m_totalBookPages;
+    LibraryCatalog m_catalog;
     
     // Book data
     std::vector<BookInfo> m_availableBooks;
     BookInfo m_currentBookInfo;
     TextSettings m_textSettings;
     PageInfo m_pageInfo;
-    String m_bookContent;
-    std::vector<String> m_pages;
+    BookStream m_stream;
+    TextLayout m_layout;
+    GlyphBlitter m_blitter; // Glyph cache of the reading font
+    Paginator m_paginator; // Span of each page in m_stream, filled in the background
+    Paginator m_ingestPaginator; // Pre-paginates newly uploaded books
+    PageLineCache m_pageCache; // Line breaks of the pages around the current one
+    PageSpan m_localPage; // Last page before the position laid out without the table
+    std::vector<uint32_t> m_chapters; // Text offset of each chapter start
     bool m_bookLoaded;
+    ImageViewer m_cover;
+
+    // Last query and the pages of its hits, listed in the menu in place of its options
+    static const int SEARCH_MENU_HITS = 6;
+    String m_searchQuery;
+    std::vector<SearchHit> m_searchHits;
+    bool m_showingHits;
+    uint32_t m_savedPosition; // Reading position last written to the store
+    unsigned long m_positionChangedAt; // millis() of the last page shown
+    static const unsigned long POSITION_SAVE_DELAY = 30000;
+
+    // Book list geometry: baseline of the first row and row pitch
+    static const int BOOK_LIST_TOP = 80;
+    static const int BOOK_LIST_LINE_HEIGHT = 25;
+
+    // How far back a font change looks for the start of the current sentence
+    static const uint32_t SENTENCE_LOOKBACK = 512;
+
+    // Neighbouring pages rasterized ahead of time into off-screen frames
+    struct PrerenderedPage
+    {
+        uint32_t start;
+        FrameBuffer *frame;
+    };
+    static const int PRERENDER_SLOTS = 2;
+    PrerenderedPage m_prerendered[PRERENDER_SLOTS];
     
     // Book menu dialog
     BookMenuDialog m_bookMenu;
@@ -150,19 +218,39 @@ private:
     // Drawing helpers
     void drawHeader();
     void drawBookListContent();
+    void drawBookListRow(int bookIndex, int y);
+    int bookListVisibleRows() const;
+    int bookListScrollOffset() const;
+    void selectBook(int index); // Move the list highlight, redrawing only the affected rows
     void drawBookReaderContent();
+    void drawReaderTitle();
     void drawBookMenuDialog();
+    bool showSearchResults();
+    void handleSearchResultSelect();
     void drawLoadingIndicator();
     void drawStatusBar();
     
     // Book management helpers
-    bool loadTxtBook(const String &filepath);
-    bool loadEpubBook(const String &filepath);
-    void paginateContent();
+    bool loadCompactBook(const String &filepath);
+    PageIndexKey getPageIndexKey(const String &filepath);
+    void buildPages(uint32_t anchor = 0);
+    void paginateContent(uint32_t anchor = 0);
+    void setPagePosition(uint32_t offset);
     void calculatePages();
-    String extractTextFromPage(const String &content, int startPos, int maxChars);
     int calculateWordsPerPage();
     void initializeTextSettings();
+    void configureLayout();
+    void buildLayout(TextLayout &layout) const;
+    void applyTextSettings();
+    const PageLines *getPageLines(uint32_t start);
+    void clipPageLines(PageLines &lines, uint32_t end);
+    bool getNextPageStart(uint32_t &start);
+    bool getPreviousPageStart(uint32_t &start);
+    void prefetchPageLines();
+    bool showPrerenderedPage(EinkDisplayManager::DisplayUpdateMode mode);
+    void prerenderPages();
+    void invalidatePrerenderedPages();
+    void releasePrerenderedPages();
     
     // Navigation helpers
     void ensureValidBookSelection();
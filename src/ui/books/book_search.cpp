@@ -0,0 +1,128 @@
+#include "book_search.h"
+
+BookSearch::BookSearch()
+{
+    m_length = 0;
+    memset(m_skip, 0, sizeof(m_skip));
+}
+
+bool BookSearch::setPattern(const String &pattern)
+{
+    if (pattern.length() == 0 || pattern.length() > MAX_PATTERN)
+    {
+        m_length = 0;
+        return false;
+    }
+
+    m_length = pattern.length();
+    for (size_t i = 0; i < m_length; i++)
+    {
+        m_pattern[i] = fold(pattern[i]);
+    }
+
+    // Horspool: how far the window may shift when its last byte is c
+    memset(m_skip, m_length, sizeof(m_skip));
+    for (size_t i = 0; i + 1 < m_length; i++)
+    {
+        uint8_t c = m_pattern[i];
+        m_skip[c] = m_length - 1 - i;
+        if (c >= 'a' && c <= 'z')
+        {
+            m_skip[c - ('a' - 'A')] = m_skip[c];
+        }
+    }
+    return true;
+}
+
+bool BookSearch::scan(const String &path, uint32_t from, uint32_t to, const SearchHitSink &onHit, SearchStats &stats)
+{
+    stats.bytesScanned = 0;
+    stats.elapsedMs = 0;
+    stats.hits = 0;
+
+    if (m_length == 0)
+    {
+        return false;
+    }
+
+    File file = SD.open(path, FILE_READ);
+    if (!file)
+    {
+        Serial.println("Search: failed to open " + path);
+        return false;
+    }
+
+    uint32_t fileSize = file.size();
+    if (to == 0 || to > fileSize)
+    {
+        to = fileSize;
+    }
+
+    // Room for one block plus the tail of the previous one, so matches
+    // spanning a block boundary are still found
+    size_t capacity = BLOCK_SIZE + MAX_PATTERN;
+    uint8_t *buffer = (uint8_t *)(psramFound() ? ps_malloc(capacity) : malloc(capacity));
+    if (!buffer)
+    {
+        file.close();
+        Serial.println("Search: failed to allocate block buffer");
+        return false;
+    }
+
+    unsigned long startTime = millis();
+    const uint8_t last = m_pattern[m_length - 1];
+    uint32_t bufferStart = from;
+    size_t filled = 0;
+    bool keepGoing = true;
+
+    file.seek(from);
+    while (keepGoing && bufferStart + filled < to)
+    {
+        size_t wanted = min((size_t)(to - bufferStart - filled), BLOCK_SIZE);
+        size_t got = file.read(buffer + filled, wanted);
+        if (got == 0)
+        {
+            break;
+        }
+        filled += got;
+        stats.bytesScanned += got;
+
+        size_t pos = 0;
+        while (pos + m_length <= filled)
+        {
+            uint8_t c = buffer[pos + m_length - 1];
+            if (fold(c) == last)
+            {
+                size_t i = 0;
+                while (i + 1 < m_length && fold(buffer[pos + i]) == m_pattern[i])
+                {
+                    i++;
+                }
+                if (i + 1 == m_length)
+                {
+                    stats.hits++;
+                    if (!onHit(bufferStart + pos))
+                    {
+                        keepGoing = false;
+                        break;
+                    }
+                }
+            }
+            pos += m_skip[c];
+        }
+
+        // Carry the unmatched tail over to the next block
+        size_t keep = min(filled - min(pos, filled), m_length - 1);
+        memmove(buffer, buffer + filled - keep, keep);
+        bufferStart += filled - keep;
+        filled = keep;
+
+        yield();
+    }
+
+    free(buffer);
+    file.close();
+
+    stats.elapsedMs = millis() - startTime;
+    return true;
+}
@@ -0,0 +1,50 @@
+#ifndef BOOK_SEARCH_H
+#define BOOK_SEARCH_H
+
+#include <Arduino.h>
+#include <FS.h>
+#include <SD.h>
+#include <functional>
+
+// Throughput of one scan, for the serial log
+struct SearchStats
+{
+    uint32_t bytesScanned;
+    uint32_t elapsedMs;
+    uint32_t hits;
+
+    uint32_t kilobytesPerSecond() const
+    {
+        return elapsedMs ? (uint32_t)((uint64_t)bytesScanned * 1000 / 1024 / elapsedMs) : 0;
+    }
+};
+
+// Receives the byte offset of each match; return false to stop scanning
+typedef std::function<bool(uint32_t offset)> SearchHitSink;
+
+// Case-insensitive full-text search over a book file on SD.
+// The file is read in large blocks and matched with a Horspool skip table,
+// so most bytes are never compared and the file is never loaded whole.
+class BookSearch
+{
+public:
+    static const size_t BLOCK_SIZE = 16384;
+    static const size_t MAX_PATTERN = 64;
+
+    BookSearch();
+
+    bool setPattern(const String &pattern);
+    size_t patternLength() const { return m_length; }
+
+    // Scan [from, to) of the file at path, to = 0 means up to the end
+    bool scan(const String &path, uint32_t from, uint32_t to, const SearchHitSink &onHit, SearchStats &stats);
+
+private:
+    static uint8_t fold(uint8_t c) { return (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c; }
+
+    uint8_t m_pattern[MAX_PATTERN];
+    size_t m_length;
+    uint8_t m_skip[256];
+};
+
+#endif // BOOK_SEARCH_H
@@ -0,0 +1,122 @@
+#include "book_stream.h"
+#include <algorithm>
+
+BookStream::BookStream()
+{
+    m_window = nullptr;
+    m_windowStart = 0;
+    m_windowLength = 0;
+    m_fileSize = 0;
+}
+
+BookStream::~BookStream()
+{
+    close();
+}
+
+bool BookStream::open(const String &filepath)
+{
+    close();
+
+    m_file = SD.open(filepath, FILE_READ);
+    if (!m_file)
+    {
+        Serial.println("BookStream: failed to open " + filepath);
+        return false;
+    }
+
+    m_window = (char *)malloc(WINDOW_SIZE);
+    if (!m_window)
+    {
+        Serial.println("BookStream: failed to allocate read window");
+        m_file.close();
+        return false;
+    }
+
+    m_fileSize = m_file.size();
+    m_path = filepath;
+    return true;
+}
+
+void BookStream::close()
+{
+    if (m_file)
+    {
+        m_file.close();
+    }
+
+    free(m_window);
+    m_window = nullptr;
+    m_windowStart = 0;
+    m_windowLength = 0;
+    m_fileSize = 0;
+}
+
+bool BookStream::isOpen() const
+{
+    return m_window != nullptr;
+}
+
+size_t BookStream::size() const
+{
+    return m_fileSize;
+}
+
+size_t BookStream::read(size_t offset, char *dest, size_t len)
+{
+    size_t copied = 0;
+    while (copied < len && offset + copied < m_fileSize)
+    {
+        size_t pos = offset + copied;
+        if (pos < m_windowStart || pos >= m_windowStart + m_windowLength)
+        {
+            if (!fillWindow(pos))
+            {
+                break;
+            }
+        }
+
+        size_t rel = pos - m_windowStart;
+        size_t chunk = std::min(len - copied, m_windowLength - rel);
+        memcpy(dest + copied, m_window + rel, chunk);
+        copied += chunk;
+    }
+    return copied;
+}
+
+int BookStream::slowCharAt(size_t offset)
+{
+    if (offset >= m_fileSize || !fillWindow(offset))
+    {
+        return -1;
+    }
+    return (uint8_t)m_window[offset - m_windowStart];
+}
+
+bool BookStream::fillWindow(size_t offset)
+{
+    if (!m_window)
+    {
+        return false;
+    }
+
+    // Keep a quarter of the window behind the requested offset so that
+    // backward scans for word and page breaks stay inside the window
+    size_t start = offset > WINDOW_SIZE / 4 ? offset - WINDOW_SIZE / 4 : 0;
+
+    if (!m_file.seek(start))
+    {
+        Serial.println("BookStream: seek failed at " + String(start));
+        return false;
+    }
+
+    size_t bytesRead = m_file.read((uint8_t *)m_window, WINDOW_SIZE);
+    if (bytesRead == 0)
+    {
+        return false;
+    }
+
+    m_windowStart = start;
+    m_windowLength = bytesRead;
+    return true;
+}
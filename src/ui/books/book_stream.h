@@ -0,0 +1,52 @@
+#ifndef BOOK_STREAM_H
+#define BOOK_STREAM_H
+
+#include <Arduino.h>
+#include <FS.h>
+#include <SD.h>
+
+// Sliding-window reader over a book's text file on SD.
+// Only WINDOW_SIZE bytes of the file are held in RAM; any other range is
+// read from the card on demand, so book size is bounded by the card and
+// not by the heap.
+class BookStream
+{
+public:
+    static const size_t WINDOW_SIZE = 8192;
+
+    BookStream();
+    ~BookStream();
+
+    bool open(const String &filepath);
+    void close();
+    bool isOpen() const;
+    size_t size() const;
+    const String &path() const { return m_path; }
+
+    // Byte at offset, or -1 past the end of the file
+    int charAt(size_t offset)
+    {
+        size_t rel = offset - m_windowStart;
+        if (offset >= m_windowStart && rel < m_windowLength)
+        {
+            return (uint8_t)m_window[rel];
+        }
+        return slowCharAt(offset);
+    }
+
+    // Copy up to len bytes starting at offset into dest, returns bytes copied
+    size_t read(size_t offset, char *dest, size_t len);
+
+private:
+    int slowCharAt(size_t offset);
+    bool fillWindow(size_t offset);
+
+    File m_file;
+    String m_path;
+    char *m_window;
+    size_t m_windowStart;
+    size_t m_windowLength;
+    size_t m_fileSize;
+};
+
+#endif // BOOK_STREAM_H
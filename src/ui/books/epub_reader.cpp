@@ -0,0 +1,576 @@
+#include "epub_reader.h"
+#include "page_index.h"
+
+#if __has_include("esp32/rom/miniz.h")
+#include "esp32/rom/miniz.h"
+#else
+#include "rom/miniz.h"
+#endif
+
+static const uint32_t ZIP_LOCAL_HEADER_SIG = 0x04034b50;
+static const uint32_t ZIP_CENTRAL_HEADER_SIG = 0x02014b50;
+static const uint32_t ZIP_END_OF_DIR_SIG = 0x06054b50;
+static const size_t ZIP_LOCAL_HEADER_SIZE = 30;
+static const size_t ZIP_CENTRAL_HEADER_SIZE = 46;
+static const size_t ZIP_END_OF_DIR_SIZE = 22;
+static const uint16_t ZIP_METHOD_STORED = 0;
+static const uint16_t ZIP_METHOD_DEFLATE = 8;
+
+static const size_t INPUT_CHUNK_SIZE = 1024;
+static const size_t MAX_TAG_LENGTH = 512;
+static const size_t MAX_TEXT_LENGTH = 128;
+
+static uint16_t readLE16(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8);
+}
+
+static uint32_t readLE32(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// Compares the element name of a tag, ignoring any namespace prefix
+static bool tagNameIs(const char *tag, const char *name)
+{
+    size_t length = 0;
+    while (tag[length] && !isspace((unsigned char)tag[length]) && tag[length] != '/')
+    {
+        length++;
+    }
+
+    const char *colon = (const char *)memchr(tag, ':', length);
+    if (colon)
+    {
+        length -= (colon + 1 - tag);
+        tag = colon + 1;
+    }
+    return length == strlen(name) && strncmp(tag, name, length) == 0;
+}
+
+EpubReader::EpubReader()
+{
+}
+
+EpubReader::~EpubReader()
+{
+    close();
+}
+
+bool EpubReader::open(const String &filepath)
+{
+    close();
+
+    m_file = SD.open(filepath, FILE_READ);
+    if (!m_file)
+    {
+        Serial.println("EPUB: failed to open " + filepath);
+        return false;
+    }
+
+    if (!readCentralDirectory())
+    {
+        Serial.println("EPUB: not a valid ZIP archive");
+        close();
+        return false;
+    }
+
+    // container.xml names the OPF package document
+    const ZipEntry *container = findEntry("META-INF/container.xml");
+    if (!container)
+    {
+        Serial.println("EPUB: META-INF/container.xml missing");
+        close();
+        return false;
+    }
+
+    String opfPath;
+    scanTags(*container, [&opfPath](const char *tag, const String &text)
+             {
+        if (opfPath.isEmpty() && tagNameIs(tag, "rootfile"))
+        {
+            opfPath = getAttribute(tag, "full-path");
+        } });
+
+    if (opfPath.isEmpty() || !readPackage(opfPath))
+    {
+        Serial.println("EPUB: package document missing or empty");
+        close();
+        return false;
+    }
+
+    // Only the spine is needed from here on
+    std::vector<ZipEntry>().swap(m_entries);
+
+    Serial.println("EPUB: " + String(m_chapters.size()) + " chapters in spine");
+    return true;
+}
+
+void EpubReader::close()
+{
+    if (m_file)
+    {
+        m_file.close();
+    }
+    std::vector<ZipEntry>().swap(m_entries);
+    std::vector<ZipEntry>().swap(m_chapters);
+    m_title = "";
+    m_author = "";
+}
+
+int EpubReader::getChapterCount() const
+{
+    return m_chapters.size();
+}
+
+bool EpubReader::streamChapter(int index, const EpubDataSink &sink)
+{
+    if (index < 0 || index >= (int)m_chapters.size())
+    {
+        return false;
+    }
+    return streamEntry(m_chapters[index], sink);
+}
+
+String EpubReader::getTitle() const
+{
+    return m_title;
+}
+
+String EpubReader::getAuthor() const
+{
+    return m_author;
+}
+
+bool EpubReader::readCentralDirectory()
+{
+    size_t fileSize = m_file.size();
+    if (fileSize < ZIP_END_OF_DIR_SIZE)
+    {
+        return false;
+    }
+
+    // The end-of-directory record sits at the very end unless the archive has
+    // a comment, so search backwards through the last kilobyte
+    uint8_t tail[1024];
+    size_t tailSize = std::min(fileSize, sizeof(tail));
+    if (!m_file.seek(fileSize - tailSize) || m_file.read(tail, tailSize) != tailSize)
+    {
+        return false;
+    }
+
+    const uint8_t *eocd = nullptr;
+    for (int i = tailSize - ZIP_END_OF_DIR_SIZE; i >= 0; i--)
+    {
+        if (readLE32(tail + i) == ZIP_END_OF_DIR_SIG)
+        {
+            eocd = tail + i;
+            break;
+        }
+    }
+    if (!eocd)
+    {
+        return false;
+    }
+
+    uint16_t entryCount = readLE16(eocd + 10);
+    uint32_t directoryOffset = readLE32(eocd + 16);
+    if (!m_file.seek(directoryOffset))
+    {
+        return false;
+    }
+
+    m_entries.reserve(entryCount);
+
+    uint8_t header[ZIP_CENTRAL_HEADER_SIZE];
+    char name[256];
+    for (uint16_t i = 0; i < entryCount; i++)
+    {
+        if (m_file.read(header, sizeof(header)) != sizeof(header) ||
+            readLE32(header) != ZIP_CENTRAL_HEADER_SIG)
+        {
+            return false;
+        }
+
+        uint16_t nameLength = readLE16(header + 28);
+        uint16_t extraLength = readLE16(header + 30);
+        uint16_t commentLength = readLE16(header + 32);
+
+        size_t stored = std::min((size_t)nameLength, sizeof(name));
+        if (m_file.read((uint8_t *)name, stored) != stored)
+        {
+            return false;
+        }
+
+        ZipEntry entry;
+        entry.nameHash = hashName(name, stored);
+        entry.method = readLE16(header + 10);
+        entry.compressedSize = readLE32(header + 20);
+        entry.uncompressedSize = readLE32(header + 24);
+        entry.localHeaderOffset = readLE32(header + 42);
+        m_entries.push_back(entry);
+
+        size_t skip = (nameLength - stored) + extraLength + commentLength;
+        if (skip > 0 && !m_file.seek(m_file.position() + skip))
+        {
+            return false;
+        }
+    }
+
+    return !m_entries.empty();
+}
+
+const EpubReader::ZipEntry *EpubReader::findEntry(const String &name)
+{
+    uint32_t hash = hashName(name.c_str(), name.length());
+    for (const ZipEntry &entry : m_entries)
+    {
+        // Different names can share a hash, so a match is confirmed against the archive
+        if (entry.nameHash == hash && entryNameIs(entry, name))
+        {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+bool EpubReader::entryNameIs(const ZipEntry &entry, const String &name)
+{
+    // The local header repeats the entry's name right after its fixed part
+    uint8_t local[ZIP_LOCAL_HEADER_SIZE];
+    if (!m_file.seek(entry.localHeaderOffset) ||
+        m_file.read(local, sizeof(local)) != sizeof(local) ||
+        readLE32(local) != ZIP_LOCAL_HEADER_SIG ||
+        readLE16(local + 26) != name.length())
+    {
+        return false;
+    }
+
+    char stored[64];
+    for (size_t done = 0; done < name.length();)
+    {
+        size_t chunk = std::min(name.length() - done, sizeof(stored));
+        if (m_file.read((uint8_t *)stored, chunk) != chunk || memcmp(stored, name.c_str() + done, chunk) != 0)
+        {
+            return false;
+        }
+        done += chunk;
+    }
+    return true;
+}
+
+bool EpubReader::streamEntry(const ZipEntry &entry, const EpubDataSink &sink)
+{
+    uint8_t local[ZIP_LOCAL_HEADER_SIZE];
+    if (!m_file.seek(entry.localHeaderOffset) ||
+        m_file.read(local, sizeof(local)) != sizeof(local) ||
+        readLE32(local) != ZIP_LOCAL_HEADER_SIG)
+    {
+        Serial.println("EPUB: bad local header");
+        return false;
+    }
+
+    // Sizes come from the central directory, which is valid even when the
+    // local header defers them to a data descriptor
+    uint32_t dataOffset = entry.localHeaderOffset + ZIP_LOCAL_HEADER_SIZE + readLE16(local + 26) + readLE16(local + 28);
+    if (!m_file.seek(dataOffset))
+    {
+        return false;
+    }
+
+    uint8_t *input = (uint8_t *)malloc(INPUT_CHUNK_SIZE);
+    if (!input)
+    {
+        return false;
+    }
+
+    uint32_t remaining = entry.compressedSize;
+    bool ok = true;
+
+    if (entry.method == ZIP_METHOD_STORED)
+    {
+        while (ok && remaining > 0)
+        {
+            size_t chunk = m_file.read(input, std::min((uint32_t)INPUT_CHUNK_SIZE, remaining));
+            if (chunk == 0)
+            {
+                ok = false;
+                break;
+            }
+            remaining -= chunk;
+            ok = sink((const char *)input, chunk);
+        }
+        free(input);
+        return ok;
+    }
+
+    if (entry.method != ZIP_METHOD_DEFLATE)
+    {
+        Serial.println("EPUB: unsupported compression method " + String(entry.method));
+        free(input);
+        return false;
+    }
+
+    // The decompressor writes into a circular 32KB dictionary, which doubles
+    // as the output buffer handed to the sink
+    tinfl_decompressor *inflator = (tinfl_decompressor *)malloc(sizeof(tinfl_decompressor));
+    uint8_t *dictionary = (uint8_t *)malloc(TINFL_LZ_DICT_SIZE);
+    if (!inflator || !dictionary)
+    {
+        Serial.println("EPUB: not enough memory to inflate");
+        free(inflator);
+        free(dictionary);
+        free(input);
+        return false;
+    }
+
+    tinfl_init(inflator);
+    size_t inputPos = 0;
+    size_t inputAvailable = 0;
+    size_t dictionaryPos = 0;
+
+    while (ok)
+    {
+        if (inputPos == inputAvailable && remaining > 0)
+        {
+            inputAvailable = m_file.read(input, std::min((uint32_t)INPUT_CHUNK_SIZE, remaining));
+            inputPos = 0;
+            remaining -= inputAvailable;
+            if (inputAvailable == 0)
+            {
+                ok = false;
+                break;
+            }
+        }
+
+        size_t inBytes = inputAvailable - inputPos;
+        size_t outBytes = TINFL_LZ_DICT_SIZE - dictionaryPos;
+        tinfl_status status = tinfl_decompress(inflator, input + inputPos, &inBytes,
+                                               dictionary, dictionary + dictionaryPos, &outBytes,
+                                               remaining > 0 ? TINFL_FLAG_HAS_MORE_INPUT : 0);
+        inputPos += inBytes;
+
+        if (outBytes > 0)
+        {
+            ok = sink((const char *)dictionary + dictionaryPos, outBytes);
+            dictionaryPos = (dictionaryPos + outBytes) & (TINFL_LZ_DICT_SIZE - 1);
+        }
+
+        if (status == TINFL_STATUS_DONE)
+        {
+            break;
+        }
+        if (status < 0 || (status == TINFL_STATUS_NEEDS_MORE_INPUT && inputPos == inputAvailable && remaining == 0))
+        {
+            Serial.println("EPUB: inflate failed with status " + String((int)status));
+            ok = false;
+        }
+
+        yield();
+    }
+
+    free(inflator);
+    free(dictionary);
+    free(input);
+    return ok;
+}
+
+bool EpubReader::scanTags(const ZipEntry &entry, const std::function<void(const char *tag, const String &text)> &onTag)
+{
+    // Tags are collected into a fixed buffer; oversized tags are skipped
+    char *tag = (char *)malloc(MAX_TAG_LENGTH + 1);
+    if (!tag)
+    {
+        return false;
+    }
+
+    size_t tagLength = 0;
+    bool inTag = false;
+    bool overflow = false;
+    String text;
+
+    bool ok = streamEntry(entry, [&](const char *data, size_t length)
+                          {
+        for (size_t i = 0; i < length; i++)
+        {
+            char c = data[i];
+            if (c == '<')
+            {
+                inTag = true;
+                overflow = false;
+                tagLength = 0;
+            }
+            else if (c == '>' && inTag)
+            {
+                inTag = false;
+                if (!overflow)
+                {
+                    tag[tagLength] = '\0';
+                    onTag(tag, text);
+                }
+                text = "";
+            }
+            else if (inTag)
+            {
+                if (tagLength < MAX_TAG_LENGTH)
+                {
+                    tag[tagLength++] = c;
+                }
+                else
+                {
+                    overflow = true;
+                }
+            }
+            else if (text.length() < MAX_TEXT_LENGTH)
+            {
+                text += c;
+            }
+        }
+        return true; });
+
+    free(tag);
+    return ok;
+}
+
+bool EpubReader::readPackage(const String &opfPath)
+{
+    const ZipEntry *package = findEntry(opfPath);
+    if (!package)
+    {
+        return false;
+    }
+
+    int slash = opfPath.lastIndexOf('/');
+    String baseDir = slash >= 0 ? opfPath.substring(0, slash + 1) : "";
+
+    // The manifest maps item ids to files, the spine lists ids in reading order
+    struct ManifestItem
+    {
+        String id;
+        String href;
+    };
+    std::vector<ManifestItem> manifest;
+    std::vector<String> spine;
+
+    scanTags(*package, [&](const char *tag, const String &text)
+             {
+        if (tagNameIs(tag, "item"))
+        {
+            String mediaType = getAttribute(tag, "media-type");
+            if (mediaType == "application/xhtml+xml" || mediaType == "text/html")
+            {
+                manifest.push_back({getAttribute(tag, "id"), getAttribute(tag, "href")});
+            }
+        }
+        else if (tagNameIs(tag, "itemref"))
+        {
+            if (getAttribute(tag, "linear") != "no")
+            {
+                spine.push_back(getAttribute(tag, "idref"));
+            }
+        }
+        else if (tag[0] == '/' && tagNameIs(tag + 1, "title") && m_title.isEmpty())
+        {
+            m_title = text;
+            m_title.trim();
+        }
+        else if (tag[0] == '/' && tagNameIs(tag + 1, "creator") && m_author.isEmpty())
+        {
+            m_author = text;
+            m_author.trim();
+        } });
+
+    for (const String &idref : spine)
+    {
+        for (const ManifestItem &item : manifest)
+        {
+            if (item.id == idref)
+            {
+                const ZipEntry *entry = findEntry(resolvePath(baseDir, item.href));
+                if (entry)
+                {
+                    m_chapters.push_back(*entry);
+                }
+                break;
+            }
+        }
+    }
+
+    return !m_chapters.empty();
+}
+
+uint32_t EpubReader::hashName(const char *name, size_t length)
+{
+    return PageIndex::hash(name, length);
+}
+
+String EpubReader::getAttribute(const char *tag, const char *name)
+{
+    // Matches name="value" or name='value' preceded by whitespace
+    size_t nameLength = strlen(name);
+    for (const char *p = strstr(tag, name); p; p = strstr(p + 1, name))
+    {
+        if (p == tag || !isspace((unsigned char)p[-1]))
+        {
+            continue;
+        }
+
+        const char *q = p + nameLength;
+        while (isspace((unsigned char)*q))
+            q++;
+        if (*q != '=')
+            continue;
+        q++;
+        while (isspace((unsigned char)*q))
+            q++;
+
+        char quote = *q;
+        if (quote != '"' && quote != '\'')
+            continue;
+
+        const char *end = strchr(q + 1, quote);
+        if (!end)
+            return "";
+
+        String value;
+        value.reserve(end - q - 1);
+        for (const char *c = q + 1; c < end; c++)
+        {
+            value += *c;
+        }
+        return value;
+    }
+    return "";
+}
+
+String EpubReader::resolvePath(const String &baseDir, const String &href)
+{
+    // Drop any fragment and decode %XX escapes
+    String decoded;
+    for (unsigned int i = 0; i < href.length(); i++)
+    {
+        char c = href.charAt(i);
+        if (c == '#')
+        {
+            break;
+        }
+        if (c == '%' && i + 2 < href.length())
+        {
+            char hex[3] = {href.charAt(i + 1), href.charAt(i + 2), '\0'};
+            decoded += (char)strtol(hex, nullptr, 16);
+            i += 2;
+            continue;
+        }
+        decoded += c;
+    }
+
+    // Collapse "../" segments against the package directory
+    String path = baseDir;
+    while (decoded.startsWith("../"))
+    {
+        decoded = decoded.substring(3);
+        int slash = path.length() > 1 ? path.lastIndexOf('/', path.length() - 2) : -1;
+        path = slash >= 0 ? path.substring(0, slash + 1) : "";
+    }
+    return path + decoded;
+}
@@ -0,0 +1,61 @@
+#ifndef EPUB_READER_H
+#define EPUB_READER_H
+
+#include <Arduino.h>
+#include <FS.h>
+#include <SD.h>
+#include <functional>
+#include <vector>
+
+// Receives uncompressed bytes of a ZIP entry; return false to stop early
+typedef std::function<bool(const char *data, size_t length)> EpubDataSink;
+
+// Streaming EPUB backend.
+// Parses the ZIP central directory, follows META-INF/container.xml to the
+// OPF package and resolves its spine to chapter entries. Chapters are then
+// inflated chunk by chunk into a sink, so neither the archive nor a whole
+// chapter is ever held in RAM; only the 32KB deflate window is.
+class EpubReader
+{
+public:
+    EpubReader();
+    ~EpubReader();
+
+    bool open(const String &filepath);
+    void close();
+
+    int getChapterCount() const;
+    bool streamChapter(int index, const EpubDataSink &sink);
+
+    String getTitle() const;
+    String getAuthor() const;
+
+private:
+    struct ZipEntry
+    {
+        uint32_t nameHash;
+        uint32_t localHeaderOffset;
+        uint32_t compressedSize;
+        uint32_t uncompressedSize;
+        uint16_t method;
+    };
+
+    bool readCentralDirectory();
+    const ZipEntry *findEntry(const String &name);
+    bool entryNameIs(const ZipEntry &entry, const String &name);
+    bool streamEntry(const ZipEntry &entry, const EpubDataSink &sink);
+    bool scanTags(const ZipEntry &entry, const std::function<void(const char *tag, const String &text)> &onTag);
+    bool readPackage(const String &opfPath);
+
+    static uint32_t hashName(const char *name, size_t length);
+    static String getAttribute(const char *tag, const char *name);
+    static String resolvePath(const String &baseDir, const String &href);
+
+    File m_file;
+    std::vector<ZipEntry> m_entries;
+    std::vector<ZipEntry> m_chapters;
+    String m_title;
+    String m_author;
+};
+
+#endif // EPUB_READER_H
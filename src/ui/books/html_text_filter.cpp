@@ -0,0 +1,223 @@
+#include "html_text_filter.h"
+
+// Tags that end a line of text, and those that start a new paragraph
+static const char *LINE_TAGS[] = {"br", "div", "li", "tr", "h1", "h2", "h3", "h4", "h5", "h6", "blockquote", "hr"};
+static const char *PARAGRAPH_TAGS[] = {"p", "h1", "h2", "h3", "h4", "h5", "h6", "blockquote"};
+static const char *SKIPPED_TAGS[] = {"head", "style", "script"};
+
+static bool tagIn(const char *name, const char *const *list, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        if (strcmp(name, list[i]) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+HtmlTextFilter::HtmlTextFilter()
+{
+    reset();
+}
+
+void HtmlTextFilter::reset()
+{
+    m_inTag = false;
+    m_inEntity = false;
+    m_tagNameDone = false;
+    m_pendingSpace = false;
+    m_newlines = 2; // Suppress leading blank lines
+    m_skipDepth = 0;
+    m_tagLength = 0;
+    m_entityLength = 0;
+}
+
+size_t HtmlTextFilter::feed(const char *in, size_t len, char *out)
+{
+    size_t written = 0;
+
+    for (size_t i = 0; i < len; i++)
+    {
+        char c = in[i];
+
+        if (m_inTag)
+        {
+            if (c == '>')
+            {
+                m_inTag = false;
+                m_tagName[m_tagLength] = '\0';
+                handleTag(out, written);
+            }
+            else if (!m_tagNameDone)
+            {
+                bool nameChar = isalnum((unsigned char)c) || (c == '/' && m_tagLength == 0);
+                if (nameChar && m_tagLength < sizeof(m_tagName) - 1)
+                {
+                    m_tagName[m_tagLength++] = tolower((unsigned char)c);
+                }
+                else if (!nameChar)
+                {
+                    m_tagNameDone = true;
+                }
+            }
+            continue;
+        }
+
+        if (c == '<')
+        {
+            m_inTag = true;
+            m_inEntity = false;
+            m_tagNameDone = false;
+            m_tagLength = 0;
+            continue;
+        }
+
+        if (m_skipDepth > 0)
+        {
+            continue;
+        }
+
+        if (m_inEntity)
+        {
+            if (c == ';')
+            {
+                m_inEntity = false;
+                m_entity[m_entityLength] = '\0';
+                c = decodeEntity();
+                if (c == 0)
+                {
+                    continue;
+                }
+            }
+            else if (m_entityLength < sizeof(m_entity) - 1 && c != ' ' && c != '\n')
+            {
+                m_entity[m_entityLength++] = c;
+                continue;
+            }
+            else
+            {
+                // Not an entity after all, drop it
+                m_inEntity = false;
+                continue;
+            }
+        }
+        else if (c == '&')
+        {
+            m_inEntity = true;
+            m_entityLength = 0;
+            continue;
+        }
+
+        if (c == ' ' || c == '\n' || c == '\r' || c == '\t')
+        {
+            m_pendingSpace = true;
+            continue;
+        }
+
+        if (m_pendingSpace && m_newlines == 0)
+        {
+            out[written++] = ' ';
+        }
+        m_pendingSpace = false;
+        m_newlines = 0;
+        out[written++] = c;
+    }
+
+    return written;
+}
+
+void HtmlTextFilter::handleTag(char *out, size_t &written)
+{
+    const char *name = m_tagName;
+    bool closing = (name[0] == '/');
+    if (closing)
+    {
+        name++;
+    }
+
+    if (tagIn(name, SKIPPED_TAGS, sizeof(SKIPPED_TAGS) / sizeof(SKIPPED_TAGS[0])))
+    {
+        if (closing && m_skipDepth > 0)
+        {
+            m_skipDepth--;
+        }
+        else if (!closing)
+        {
+            m_skipDepth++;
+        }
+        return;
+    }
+
+    if (m_skipDepth > 0)
+    {
+        return;
+    }
+
+    if (strcmp(name, "br") == 0)
+    {
+        // Explicit line breaks are never merged
+        out[written++] = '\n';
+        m_newlines = m_newlines < 2 ? m_newlines + 1 : 2;
+        m_pendingSpace = false;
+    }
+    else if (tagIn(name, PARAGRAPH_TAGS, sizeof(PARAGRAPH_TAGS) / sizeof(PARAGRAPH_TAGS[0])))
+    {
+        breakLine(out, written, 2);
+    }
+    else if (tagIn(name, LINE_TAGS, sizeof(LINE_TAGS) / sizeof(LINE_TAGS[0])))
+    {
+        breakLine(out, written, 1);
+    }
+}
+
+char HtmlTextFilter::decodeEntity() const
+{
+    if (m_entity[0] == '#')
+    {
+        long code = (m_entity[1] == 'x' || m_entity[1] == 'X') ? strtol(m_entity + 2, nullptr, 16) : strtol(m_entity + 1, nullptr, 10);
+        if (code == 160 || code == 8194 || code == 8195)
+        {
+            return ' ';
+        }
+        if (code == 8216 || code == 8217)
+        {
+            return '\'';
+        }
+        if (code == 8220 || code == 8221)
+        {
+            return '"';
+        }
+        if (code == 8211 || code == 8212)
+        {
+            return '-';
+        }
+        return (code >= 32 && code < 127) ? (char)code : 0;
+    }
+
+    if (strcmp(m_entity, "amp") == 0)
+        return '&';
+    if (strcmp(m_entity, "lt") == 0)
+        return '<';
+    if (strcmp(m_entity, "gt") == 0)
+        return '>';
+    if (strcmp(m_entity, "quot") == 0)
+        return '"';
+    if (strcmp(m_entity, "apos") == 0)
+        return '\'';
+    if (strcmp(m_entity, "nbsp") == 0)
+        return ' ';
+
+    return 0;
+}
+
+void HtmlTextFilter::breakLine(char *out, size_t &written, uint8_t count)
+{
+    while (m_newlines < count)
+    {
+        out[written++] = '\n';
+        m_newlines++;
+    }
+    m_pendingSpace = false;
+}
@@ -0,0 +1,37 @@
+#ifndef HTML_TEXT_FILTER_H
+#define HTML_TEXT_FILTER_H
+
+#include <Arduino.h>
+
+// Incremental HTML/XHTML to plain text filter.
+// Markup is fed in arbitrary chunks (tags and entities may span chunk
+// boundaries). Whitespace is collapsed, block-level tags become line breaks
+// and the contents of <head>, <style> and <script> are dropped.
+class HtmlTextFilter
+{
+public:
+    HtmlTextFilter();
+    void reset();
+
+    // Filter len bytes of markup into out, returns bytes written.
+    // out must hold at least 2 * len bytes.
+    size_t feed(const char *in, size_t len, char *out);
+
+private:
+    void handleTag(char *out, size_t &written);
+    char decodeEntity() const;
+    void breakLine(char *out, size_t &written, uint8_t count);
+
+    bool m_inTag;
+    bool m_inEntity;
+    bool m_tagNameDone;
+    bool m_pendingSpace;
+    uint8_t m_newlines;
+    uint8_t m_skipDepth;
+    uint8_t m_tagLength;
+    uint8_t m_entityLength;
+    char m_tagName[12];
+    char m_entity[10];
+};
+
+#endif // HTML_TEXT_FILTER_H
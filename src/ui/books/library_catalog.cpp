@@ -0,0 +1,292 @@
+#include "library_catalog.h"
+#include "book_screen.h"
+#include "epub_reader.h"
+#include "page_index.h"
+#include "../../../include/storage.h"
+
+static const char *CATALOG_PATH = "/cache/library.cat";
+static const char *CATALOG_TEMP_PATH = "/cache/library.tmp";
+static const uint32_t CATALOG_MAGIC = 0x5441434C; // "LCAT"
+
+// The first open of a session always walks the directory once
+bool LibraryCatalog::s_stale = true;
+
+LibraryCatalog::LibraryCatalog()
+{
+    m_loaded = false;
+}
+
+bool LibraryCatalog::open(const String &directory)
+{
+    if (directory != m_directory)
+    {
+        m_directory = directory;
+        m_loaded = false;
+    }
+
+    if (!m_loaded && !loadIndex())
+    {
+        s_stale = true;
+    }
+
+    if (s_stale)
+    {
+        return sync();
+    }
+    return m_loaded;
+}
+
+bool LibraryCatalog::sync()
+{
+    if (getSDCardStatus() != SD_READY)
+    {
+        return false;
+    }
+
+    unsigned long startTime = millis();
+    File dir = SD.open(m_directory);
+    if (!dir || !dir.isDirectory())
+    {
+        Serial.println("Library directory not found: " + m_directory);
+        return false;
+    }
+
+    createDirectory("/cache");
+    File previous = SD.open(CATALOG_PATH, FILE_READ);
+    File output = SD.open(CATALOG_TEMP_PATH, FILE_WRITE);
+    if (!output)
+    {
+        Serial.println("Failed to create library catalog");
+        dir.close();
+        return false;
+    }
+
+    Header header = {CATALOG_MAGIC, VERSION, sizeof(Record), 0};
+    output.write((const uint8_t *)&header, sizeof(header));
+
+    std::vector<uint32_t> hashes;
+    int added = 0;
+    int kept = 0;
+
+    // Records are written in directory order; unchanged books are copied
+    // from the previous catalog without being opened
+    File file = dir.openNextFile();
+    while (file)
+    {
+        String name = String(file.name());
+        int slash = name.lastIndexOf('/');
+        if (slash >= 0)
+        {
+            name = name.substring(slash + 1);
+        }
+
+        if (!file.isDirectory() && BookScreen::detectBookFormat(name) != FORMAT_UNKNOWN)
+        {
+            String path = m_directory + "/" + name;
+            if (path.length() > MAX_PATH_LENGTH)
+            {
+                // A truncated path would list a book that cannot be opened
+                Serial.println("Skipping book with too long a path: " + path);
+                file.close();
+                file = dir.openNextFile();
+                continue;
+            }
+            uint32_t pathHash = PageIndex::hash(path.c_str(), path.length());
+            uint32_t fileSize = file.size();
+            uint32_t modifiedTime = (uint32_t)file.getLastWrite();
+
+            Record record;
+            int index = findRecord(pathHash);
+            bool unchanged = index >= 0 && previous && readRecord(previous, index, record) &&
+                             record.fileSize == fileSize && record.modifiedTime == modifiedTime;
+
+            if (unchanged)
+            {
+                kept++;
+            }
+            else
+            {
+                memset(&record, 0, sizeof(record));
+                record.pathHash = pathHash;
+                record.fileSize = fileSize;
+                record.modifiedTime = modifiedTime;
+                record.format = BookScreen::detectBookFormat(name);
+                copyField(record.path, sizeof(record.path), path);
+                file.close();
+                describe(path, name, record);
+                added++;
+            }
+
+            output.write((const uint8_t *)&record, sizeof(record));
+            hashes.push_back(pathHash);
+        }
+
+        file.close();
+        file = dir.openNextFile();
+    }
+    dir.close();
+
+    header.count = hashes.size();
+    output.seek(0);
+    output.write((const uint8_t *)&header, sizeof(header));
+    output.close();
+    if (previous)
+    {
+        previous.close();
+    }
+
+    // Replace the catalog only when something changed
+    bool changed = added > 0 || (int)m_hashes.size() != kept || !m_loaded;
+    if (changed)
+    {
+        SD.remove(CATALOG_PATH);
+        if (!SD.rename(CATALOG_TEMP_PATH, CATALOG_PATH))
+        {
+            Serial.println("Failed to replace library catalog");
+            return false;
+        }
+    }
+    else
+    {
+        SD.remove(CATALOG_TEMP_PATH);
+    }
+
+    m_hashes.swap(hashes);
+    m_loaded = true;
+    s_stale = false;
+
+    Serial.println("Library catalog synced: " + String(m_hashes.size()) + " books, " + String(added) + " new or changed in " +
+                   String(millis() - startTime) + "ms");
+    return true;
+}
+
+int LibraryCatalog::count() const
+{
+    return m_hashes.size();
+}
+
+bool LibraryCatalog::read(int index, BookInfo &book)
+{
+    if (index < 0 || index >= count())
+    {
+        return false;
+    }
+
+    File file = SD.open(CATALOG_PATH, FILE_READ);
+    if (!file)
+    {
+        return false;
+    }
+
+    Record record;
+    bool ok = readRecord(file, index, record);
+    file.close();
+    if (!ok)
+    {
+        return false;
+    }
+
+    book.filename = String(record.path);
+    book.title = String(record.title);
+    book.author = String(record.author);
+    book.format = (BookFormat)record.format;
+    book.fileSize = record.fileSize;
+    book.isValid = true;
+    return true;
+}
+
+void LibraryCatalog::markStale()
+{
+    s_stale = true;
+}
+
+bool LibraryCatalog::loadIndex()
+{
+    m_hashes.clear();
+    if (getSDCardStatus() != SD_READY)
+    {
+        return false;
+    }
+
+    File file = SD.open(CATALOG_PATH, FILE_READ);
+    if (!file)
+    {
+        return false;
+    }
+
+    Header header;
+    bool valid = file.read((uint8_t *)&header, sizeof(header)) == sizeof(header) &&
+                 header.magic == CATALOG_MAGIC &&
+                 header.version == VERSION &&
+                 header.recordSize == sizeof(Record) &&
+                 file.size() == sizeof(Header) + header.count * sizeof(Record);
+
+    // Only the path hashes stay in RAM, records are read on demand
+    Record record;
+    for (uint32_t i = 0; valid && i < header.count; i++)
+    {
+        valid = file.read((uint8_t *)&record, sizeof(record)) == sizeof(record);
+        m_hashes.push_back(record.pathHash);
+    }
+    file.close();
+
+    if (!valid)
+    {
+        Serial.println("Discarding invalid library catalog");
+        m_hashes.clear();
+        return false;
+    }
+
+    m_loaded = true;
+    return true;
+}
+
+int LibraryCatalog::findRecord(uint32_t pathHash) const
+{
+    for (size_t i = 0; i < m_hashes.size(); i++)
+    {
+        if (m_hashes[i] == pathHash)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+bool LibraryCatalog::readRecord(File &file, int index, Record &record)
+{
+    return file.seek(sizeof(Header) + index * sizeof(Record)) &&
+           file.read((uint8_t *)&record, sizeof(record)) == sizeof(record);
+}
+
+void LibraryCatalog::describe(const String &path, const String &name, Record &record)
+{
+    // Title from the file name unless the book carries its own metadata
+    String title = name;
+    int lastDot = name.lastIndexOf('.');
+    if (lastDot > 0)
+    {
+        title = name.substring(0, lastDot);
+    }
+
+    if (record.format == FORMAT_EPUB)
+    {
+        EpubReader epub;
+        if (epub.open(path))
+        {
+            if (epub.getTitle().length() > 0)
+            {
+                title = epub.getTitle();
+            }
+            copyField(record.author, sizeof(record.author), epub.getAuthor());
+        }
+    }
+
+    copyField(record.title, sizeof(record.title), title);
+}
+
+void LibraryCatalog::copyField(char *dest, size_t size, const String &value)
+{
+    strncpy(dest, value.c_str(), size - 1);
+    dest[size - 1] = '\0';
+}
@@ -0,0 +1,72 @@
+#ifndef LIBRARY_CATALOG_H
+#define LIBRARY_CATALOG_H
+
+#include <Arduino.h>
+#include <FS.h>
+#include <SD.h>
+#include <vector>
+
+struct BookInfo;
+
+// Persistent catalog of the books in the library directory.
+// Fixed-size records in /cache/library.cat hold each book's path, size,
+// modification time, format and title, so listing
+// any page of the library is a seek and a few small reads. The directory
+// is walked once per session, or when something in it is known to have
+// changed; only new or modified books are examined during that walk.
+class LibraryCatalog
+{
+public:
+    static const uint16_t VERSION = 2;
+
+    // "/books/" plus the longest FAT long file name
+    static const size_t MAX_PATH_LENGTH = 7 + 255;
+
+    LibraryCatalog();
+
+    // Bring the catalog up to date with directory if it is stale
+    bool open(const String &directory);
+    bool sync();
+
+    int count() const;
+    bool read(int index, BookInfo &book);
+
+    // Called by anything that adds or removes files in the library
+    static void markStale();
+
+private:
+    struct Header
+    {
+        uint32_t magic;
+        uint16_t version;
+        uint16_t recordSize;
+        uint32_t count;
+    };
+
+    struct Record
+    {
+        uint32_t pathHash;
+        uint32_t fileSize;
+        uint32_t modifiedTime;
+        uint8_t format;
+        uint8_t reserved[3];
+        char path[MAX_PATH_LENGTH + 2];
+        char title[80];
+        char author[52];
+    };
+
+    bool loadIndex();
+    int findRecord(uint32_t pathHash) const;
+    bool readRecord(File &file, int index, Record &record);
+    void describe(const String &path, const String &name, Record &record);
+
+    static void copyField(char *dest, size_t size, const String &value);
+
+    String m_directory;
+    std::vector<uint32_t> m_hashes; // Path hash of every record, in catalog order
+    bool m_loaded;
+
+    static bool s_stale;
+};
+
+#endif // LIBRARY_CATALOG_H
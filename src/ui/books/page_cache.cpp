@@ -0,0 +1,66 @@
+#include "page_cache.h"
+
+PageLineCache::PageLineCache()
+{
+    clear();
+}
+
+void PageLineCache::clear()
+{
+    for (int i = 0; i < CAPACITY; i++)
+    {
+        m_entries[i].start = PageLines::NO_PAGE;
+        m_entries[i].end = 0;
+        m_entries[i].lineCount = 0;
+        m_lastUse[i] = 0;
+    }
+    m_clock = 0;
+}
+
+const PageLines *PageLineCache::find(uint32_t start)
+{
+    for (int i = 0; i < CAPACITY; i++)
+    {
+        if (m_entries[i].start == start)
+        {
+            m_lastUse[i] = ++m_clock;
+            return &m_entries[i];
+        }
+    }
+    return nullptr;
+}
+
+PageLines &PageLineCache::slotFor(uint32_t start)
+{
+    int slot = 0;
+    for (int i = 0; i < CAPACITY; i++)
+    {
+        if (m_entries[i].start == start)
+        {
+            slot = i;
+            break;
+        }
+        if (m_lastUse[i] < m_lastUse[slot])
+        {
+            slot = i;
+        }
+    }
+
+    m_entries[slot].start = start;
+    m_entries[slot].end = start;
+    m_entries[slot].lineCount = 0;
+    m_lastUse[slot] = ++m_clock;
+    return m_entries[slot];
+}
+
+void PageLineCache::forget(uint32_t start)
+{
+    for (int i = 0; i < CAPACITY; i++)
+    {
+        if (m_entries[i].start == start)
+        {
+            m_entries[i].start = PageLines::NO_PAGE;
+            m_lastUse[i] = 0;
+        }
+    }
+}
@@ -0,0 +1,45 @@
+#ifndef PAGE_CACHE_H
+#define PAGE_CACHE_H
+
+#include <Arduino.h>
+#include "text_layout.h"
+
+// Line-break table of one laid-out page
+struct PageLines
+{
+    static const uint32_t NO_PAGE = 0xFFFFFFFF;
+
+    uint32_t start; // Offset of the page's first byte, NO_PAGE when unused
+    uint32_t end;   // Offset just past the page's last drawn byte
+    int lineCount;
+    LineSpan lines[TextLayout::MAX_LINES_PER_PAGE];
+};
+
+// Small LRU of page line tables around the reading position.
+// With the current page and its neighbours cached, turning a page only
+// prints stored spans; word wrapping runs once per page, ahead of time.
+class PageLineCache
+{
+public:
+    static const int CAPACITY = 3;
+
+    PageLineCache();
+
+    void clear();
+
+    // Cached lines of the page starting at start, or null when not laid out
+    const PageLines *find(uint32_t start);
+
+    // Slot to lay a page out into, reusing the least recently used entry
+    PageLines &slotFor(uint32_t start);
+
+    // Drop the page starting at start so it is laid out again
+    void forget(uint32_t start);
+
+private:
+    PageLines m_entries[CAPACITY];
+    uint32_t m_lastUse[CAPACITY];
+    uint32_t m_clock;
+};
+
+#endif // PAGE_CACHE_H
@@ -0,0 +1,178 @@
+#include "page_index.h"
+#include <algorithm>
+#include "../../../include/storage.h"
+
+static const uint32_t PAGE_INDEX_MAGIC = 0x58444950; // "PIDX"
+
+// Spans read per SD call when loading, 4KB
+static const uint32_t LOAD_BLOCK_SPANS = 512;
+
+bool PageIndex::load(const PageIndexKey &key, PageTable &pages)
+{
+    if (getSDCardStatus() != SD_READY)
+    {
+        return false;
+    }
+
+    String path = filePath(key);
+    File file = SD.open(path, FILE_READ);
+    if (!file)
+    {
+        return false;
+    }
+
+    Header expected;
+    fillHeader(key, expected);
+
+    Header header;
+    bool valid = file.read((uint8_t *)&header, sizeof(header)) == sizeof(header) &&
+                 header.magic == expected.magic &&
+                 header.version == expected.version &&
+                 header.pathHash == expected.pathHash &&
+                 header.fileSize == expected.fileSize &&
+                 header.modifiedTime == expected.modifiedTime &&
+                 header.fontSignature == expected.fontSignature &&
+                 header.margin == expected.margin &&
+                 header.lineHeight == expected.lineHeight &&
+                 header.pageWidth == expected.pageWidth &&
+                 header.pageHeight == expected.pageHeight &&
+                 header.pageCount > 0 &&
+                 file.size() == sizeof(header) + header.pageCount * sizeof(PageSpan);
+
+    if (!valid)
+    {
+        file.close();
+        Serial.println("Discarding stale page index: " + path);
+        SD.remove(path);
+        return false;
+    }
+
+    // Spans are stored as they sit in the table, so blocks of them are read
+    // straight into its arena
+    pages.clear();
+    bool ok = pages.reserve(header.pageCount);
+    for (uint32_t done = 0; ok && done < header.pageCount;)
+    {
+        uint32_t count = std::min(header.pageCount - done, LOAD_BLOCK_SPANS);
+        PageSpan *spans = pages.extend(count);
+        size_t bytes = count * sizeof(PageSpan);
+        ok = spans && file.read((uint8_t *)spans, bytes) == bytes;
+        done += count;
+    }
+    file.close();
+
+    if (!ok)
+    {
+        pages.clear();
+        return false;
+    }
+
+    Serial.println("Loaded page index: " + String(header.pageCount) + " pages from " + path);
+    return true;
+}
+
+bool PageIndex::save(const PageIndexKey &key, const PageTable &pages)
+{
+    if (getSDCardStatus() != SD_READY || pages.empty())
+    {
+        return false;
+    }
+
+    createDirectory("/cache");
+
+    String path = filePath(key);
+    File file = SD.open(path, FILE_WRITE);
+    if (!file)
+    {
+        Serial.println("Failed to create page index: " + path);
+        return false;
+    }
+
+    Header header;
+    fillHeader(key, header);
+    header.pageCount = pages.size();
+
+    size_t bytes = pages.size() * sizeof(PageSpan);
+    bool ok = file.write((const uint8_t *)&header, sizeof(header)) == sizeof(header) &&
+              file.write((const uint8_t *)pages.data(), bytes) == bytes;
+    file.close();
+
+    if (!ok)
+    {
+        Serial.println("Failed to write page index: " + path);
+        SD.remove(path);
+        return false;
+    }
+
+    return true;
+}
+
+void PageIndex::remove(const PageIndexKey &key)
+{
+    String path = filePath(key);
+    if (SD.exists(path))
+    {
+        SD.remove(path);
+    }
+}
+
+String PageIndex::filePath(const PageIndexKey &key)
+{
+    Header header;
+    fillHeader(key, header);
+
+    // The path hash comes first so all indexes of one book share a prefix
+    uint32_t layoutHash = hash(&header, sizeof(header));
+
+    char name[32];
+    snprintf(name, sizeof(name), "/cache/%08lx_%08lx.idx", (unsigned long)header.pathHash, (unsigned long)layoutHash);
+    return String(name);
+}
+
+uint32_t PageIndex::fontSignature(const GFXfont *font)
+{
+    if (!font)
+    {
+        return 0;
+    }
+
+    // Fonts are identified by their metrics, which is what pagination depends on
+    uint32_t signature = hash(&font->first, sizeof(font->first));
+    signature = hash(&font->last, sizeof(font->last), signature);
+    signature = hash(&font->yAdvance, sizeof(font->yAdvance), signature);
+    for (uint16_t c = font->first; c <= font->last; c++)
+    {
+        uint8_t advance = pgm_read_byte(&font->glyph[c - font->first].xAdvance);
+        signature = hash(&advance, sizeof(advance), signature);
+    }
+    return signature;
+}
+
+uint32_t PageIndex::hash(const void *data, size_t length, uint32_t seed)
+{
+    // FNV-1a
+    const uint8_t *bytes = (const uint8_t *)data;
+    uint32_t value = seed;
+    for (size_t i = 0; i < length; i++)
+    {
+        value ^= bytes[i];
+        value *= 16777619u;
+    }
+    return value;
+}
+
+void PageIndex::fillHeader(const PageIndexKey &key, Header &header)
+{
+    memset(&header, 0, sizeof(header));
+    header.magic = PAGE_INDEX_MAGIC;
+    header.version = LAYOUT_VERSION;
+    header.margin = key.margin;
+    header.pathHash = hash(key.path.c_str(), key.path.length());
+    header.fileSize = key.fileSize;
+    header.modifiedTime = key.modifiedTime;
+    header.fontSignature = key.fontSignature;
+    header.lineHeight = key.lineHeight;
+    header.pageWidth = key.pageWidth;
+    header.pageHeight = key.pageHeight;
+    header.pageCount = 0;
+}
@@ -0,0 +1,60 @@
+#ifndef PAGE_INDEX_H
+#define PAGE_INDEX_H
+
+#include <Arduino.h>
+#include <Adafruit_GFX.h>
+#include "page_table.h"
+
+// Identifies one pagination of one book: the source file plus every
+// layout parameter that influences where pages break
+struct PageIndexKey
+{
+    String path;
+    uint32_t fileSize;
+    uint32_t modifiedTime;
+    uint32_t fontSignature;
+    uint16_t margin;
+    uint16_t lineHeight;
+    uint16_t pageWidth;
+    uint16_t pageHeight;
+};
+
+// Persistent page-offset index stored under /cache.
+// One small binary file per book and layout holds the span of every
+// page, so reopening a book or returning to a previously used font
+// is a single file read instead of a full re-pagination.
+class PageIndex
+{
+public:
+    // Bump whenever the pagination algorithm changes page boundaries
+    static const uint16_t LAYOUT_VERSION = 4;
+
+    static bool load(const PageIndexKey &key, PageTable &pages);
+    static bool save(const PageIndexKey &key, const PageTable &pages);
+    static void remove(const PageIndexKey &key);
+
+    static String filePath(const PageIndexKey &key);
+    static uint32_t fontSignature(const GFXfont *font);
+    static uint32_t hash(const void *data, size_t length, uint32_t seed = 2166136261u);
+
+private:
+    struct Header
+    {
+        uint32_t magic;
+        uint16_t version;
+        uint16_t margin;
+        uint32_t pathHash;
+        uint32_t fileSize;
+        uint32_t modifiedTime;
+        uint32_t fontSignature;
+        uint16_t lineHeight;
+        uint16_t pageWidth;
+        uint16_t pageHeight;
+        uint16_t reserved;
+        uint32_t pageCount;
+    };
+
+    static void fillHeader(const PageIndexKey &key, Header &header);
+};
+
+#endif // PAGE_INDEX_H
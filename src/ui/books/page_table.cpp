@@ -0,0 +1,75 @@
+#include "page_table.h"
+#include <algorithm>
+#include <utility>
+
+PageTable::PageTable()
+{
+    m_spans = nullptr;
+    m_count = 0;
+    m_capacity = 0;
+}
+
+PageTable::~PageTable()
+{
+    clear();
+}
+
+bool PageTable::push(uint32_t offset, uint32_t length)
+{
+    if (m_count == m_capacity && !reserve(m_capacity ? m_capacity * 2 : 256))
+    {
+        return false;
+    }
+
+    m_spans[m_count].offset = offset;
+    m_spans[m_count].length = length;
+    m_count++;
+    return true;
+}
+
+PageSpan *PageTable::extend(size_t count)
+{
+    if (m_count + count > m_capacity && !reserve(std::max(m_count + count, m_capacity * 2)))
+    {
+        return nullptr;
+    }
+
+    PageSpan *spans = m_spans + m_count;
+    m_count += count;
+    return spans;
+}
+
+bool PageTable::reserve(size_t count)
+{
+    if (count <= m_capacity)
+    {
+        return true;
+    }
+
+    size_t bytes = count * sizeof(PageSpan);
+    void *spans = psramFound() ? ps_realloc(m_spans, bytes) : realloc(m_spans, bytes);
+    if (!spans)
+    {
+        Serial.println("PageTable: out of memory at " + String(m_count) + " pages");
+        return false;
+    }
+
+    m_spans = (PageSpan *)spans;
+    m_capacity = count;
+    return true;
+}
+
+void PageTable::clear()
+{
+    free(m_spans);
+    m_spans = nullptr;
+    m_count = 0;
+    m_capacity = 0;
+}
+
+void PageTable::swap(PageTable &other)
+{
+    std::swap(m_spans, other.m_spans);
+    std::swap(m_count, other.m_count);
+    std::swap(m_capacity, other.m_capacity);
+}
@@ -0,0 +1,45 @@
+#ifndef PAGE_TABLE_H
+#define PAGE_TABLE_H
+
+#include <Arduino.h>
+
+// One page of the book: where its text starts and how many bytes are drawn
+struct PageSpan
+{
+    uint32_t offset;
+    uint32_t length;
+};
+
+// Page spans of a whole book in one growable arena.
+// The arena lives in PSRAM when the board has it, keeping long books off
+// the internal heap, and grows geometrically so there is no page limit.
+class PageTable
+{
+public:
+    PageTable();
+    ~PageTable();
+
+    bool push(uint32_t offset, uint32_t length);
+
+    // Grow by count spans left for the caller to fill, for bulk loads;
+    // null when out of memory
+    PageSpan *extend(size_t count);
+    bool reserve(size_t count);
+    void clear();
+    void swap(PageTable &other);
+
+    size_t size() const { return m_count; }
+    bool empty() const { return m_count == 0; }
+    const PageSpan &operator[](size_t index) const { return m_spans[index]; }
+    const PageSpan *data() const { return m_spans; }
+
+private:
+    PageTable(const PageTable &);
+    PageTable &operator=(const PageTable &);
+
+    PageSpan *m_spans;
+    size_t m_count;
+    size_t m_capacity;
+};
+
+#endif // PAGE_TABLE_H
@@ -0,0 +1,276 @@
+#include "paginator.h"
+#include <algorithm>
+
+Paginator::Paginator()
+{
+    m_mutex = nullptr;
+    m_task = nullptr;
+    m_anchor = 0;
+    m_totalBytes = 0;
+    m_bytesDone = 0;
+    m_running = false;
+    m_cancel = false;
+    m_complete = false;
+    m_failed = false;
+}
+
+Paginator::~Paginator()
+{
+    stop();
+    if (m_mutex)
+    {
+        vSemaphoreDelete(m_mutex);
+    }
+}
+
+bool Paginator::start(const String &path, const TextLayout &layout, const PageIndexKey &key, uint32_t anchor)
+{
+    clear();
+
+    // Created on first use, global objects are constructed before the scheduler runs
+    if (!m_mutex)
+    {
+        m_mutex = xSemaphoreCreateMutex();
+        if (!m_mutex)
+        {
+            Serial.println("Paginator: failed to create mutex");
+            return false;
+        }
+    }
+
+    m_path = path;
+    m_layout = layout;
+    m_key = key;
+    m_anchor = anchor;
+    m_cancel = false;
+    m_running = true;
+
+    if (xTaskCreatePinnedToCore(taskEntry, "paginate", TASK_STACK_SIZE, this, TASK_PRIORITY, &m_task, TASK_CORE) != pdPASS)
+    {
+        Serial.println("Paginator: failed to start task");
+        m_running = false;
+        m_task = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void Paginator::adopt(PageTable &pages)
+{
+    clear();
+    m_pages.swap(pages);
+    m_complete = true;
+}
+
+void Paginator::stop()
+{
+    m_cancel = true;
+    wait();
+}
+
+void Paginator::clear()
+{
+    stop();
+
+    // No task is running, so the table can be released without the lock
+    m_pages.clear();
+    m_totalBytes = 0;
+    m_bytesDone = 0;
+    m_complete = false;
+    m_failed = false;
+}
+
+int Paginator::pageCount() const
+{
+    if (!m_running)
+    {
+        return m_pages.size();
+    }
+
+    xSemaphoreTake(m_mutex, portMAX_DELAY);
+    int count = m_pages.size();
+    xSemaphoreGive(m_mutex);
+    return count;
+}
+
+bool Paginator::isComplete() const
+{
+    return m_complete;
+}
+
+int Paginator::estimatedPageCount() const
+{
+    int count = pageCount();
+    uint32_t done = m_bytesDone;
+    if (m_complete || done == 0 || done >= m_totalBytes)
+    {
+        return count;
+    }
+
+    int estimate = (uint64_t)count * m_totalBytes / done;
+    return std::max(estimate, count);
+}
+
+bool Paginator::getPage(int page, PageSpan &span) const
+{
+    if (page < 0)
+    {
+        return false;
+    }
+
+    bool locked = m_running;
+    if (locked)
+    {
+        xSemaphoreTake(m_mutex, portMAX_DELAY);
+    }
+
+    bool found = page < (int)m_pages.size();
+    if (found)
+    {
+        span = m_pages[page];
+    }
+
+    if (locked)
+    {
+        xSemaphoreGive(m_mutex);
+    }
+    return found;
+}
+
+int Paginator::findPage(uint32_t offset) const
+{
+    bool locked = m_running;
+    if (locked)
+    {
+        xSemaphoreTake(m_mutex, portMAX_DELAY);
+    }
+
+    // Last page starting at or before offset, valid once the page after it
+    // is known or the table is complete
+    int found = -1;
+    int count = m_pages.size();
+    if (count > 0 && (m_complete || offset < m_bytesDone))
+    {
+        int low = 0;
+        int high = count - 1;
+        while (low < high)
+        {
+            int mid = (low + high + 1) / 2;
+            if (m_pages[mid].offset <= offset)
+            {
+                low = mid;
+            }
+            else
+            {
+                high = mid - 1;
+            }
+        }
+        found = m_pages[low].offset <= offset ? low : -1;
+    }
+
+    if (locked)
+    {
+        xSemaphoreGive(m_mutex);
+    }
+    return found;
+}
+
+void Paginator::wait()
+{
+    while (m_running)
+    {
+        vTaskDelay(1);
+    }
+    m_task = nullptr;
+}
+
+void Paginator::taskEntry(void *param)
+{
+    Paginator *paginator = static_cast<Paginator *>(param);
+    paginator->run();
+
+    // Nothing of the paginator may be touched once m_running drops
+    paginator->m_running = false;
+    vTaskDelete(nullptr);
+}
+
+void Paginator::run()
+{
+    unsigned long startTime = millis();
+
+    // A private stream keeps this task's window independent of the reader's
+    BookStream stream;
+    if (!stream.open(m_path))
+    {
+        Serial.println("Paginator: cannot open " + m_path);
+        m_failed = true;
+        return;
+    }
+
+    m_totalBytes = stream.size();
+    uint32_t pos = m_layout.skipBlank(stream, 0);
+    int pageCount = 0;
+    bool anchorCut = false;
+
+    while (pos < m_totalBytes && !m_cancel)
+    {
+        uint32_t pageStart = pos;
+
+        // Pages end exactly where the drawn text ends
+        int lineCount = 0;
+        uint32_t pageEnd = m_layout.layoutPage(stream, pos, nullptr, lineCount);
+        pos = m_layout.skipBlank(stream, pageEnd);
+
+        // A page never runs across the anchor, the one holding it ends short
+        if (m_anchor > pageStart && m_anchor < pos)
+        {
+            pageEnd = std::min(pageEnd, m_anchor);
+            pos = m_anchor;
+            anchorCut = true;
+        }
+
+        if (!publish(pageStart, pageEnd - pageStart, pos))
+        {
+            m_failed = true;
+            break;
+        }
+        pageCount++;
+
+        // Let the idle task on this core run so its watchdog is fed
+        if (pageCount % 8 == 0)
+        {
+            vTaskDelay(1);
+        }
+    }
+
+    stream.close();
+    if (m_cancel || pos < m_totalBytes)
+    {
+        return;
+    }
+
+    m_complete = true;
+    Serial.println("Pagination complete: " + String(pageCount) + " pages in " + String(millis() - startTime) + "ms");
+
+    // Pages after a cut anchor are shifted, and the key does not hold the
+    // anchor, so that table is kept out of the index for later opens
+    if (anchorCut)
+    {
+        Serial.println("Page index not saved, pages follow the reading position");
+        return;
+    }
+
+    if (!PageIndex::save(m_key, m_pages))
+    {
+        Serial.println("Page index not saved, book will be paginated again next time");
+    }
+}
+
+bool Paginator::publish(uint32_t offset, uint32_t length, uint32_t bytesDone)
+{
+    xSemaphoreTake(m_mutex, portMAX_DELAY);
+    bool ok = m_pages.push(offset, length);
+    m_bytesDone = bytesDone;
+    xSemaphoreGive(m_mutex);
+    return ok;
+}
@@ -0,0 +1,81 @@
+#ifndef PAGINATOR_H
+#define PAGINATOR_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#include "book_stream.h"
+#include "page_index.h"
+#include "page_table.h"
+#include "text_layout.h"
+
+// Background pagination of the open book.
+// A FreeRTOS task pinned to the core the Arduino loop does not use walks
+// the book with its own stream and layout copy, publishing each page start
+// as soon as it is known. The reader can show and turn pages while later
+// pages are still being computed; the finished table is saved to the
+// page index.
+class Paginator
+{
+public:
+    static const BaseType_t TASK_CORE = 0;
+    static const UBaseType_t TASK_PRIORITY = 1;
+    static const uint32_t TASK_STACK_SIZE = 6144;
+
+    Paginator();
+    ~Paginator();
+
+    // Start paginating path in the background, replacing any previous run.
+    // A non-zero anchor is guaranteed to start a page, so a reading position
+    // can be shown before pagination reaches it
+    bool start(const String &path, const TextLayout &layout, const PageIndexKey &key, uint32_t anchor = 0);
+
+    // Adopt a complete page table, e.g. one loaded from the page index
+    void adopt(PageTable &pages);
+
+    // Cancel a running task and wait for it to exit
+    void stop();
+    void clear();
+
+    int pageCount() const;
+    bool isComplete() const;
+    bool isRunning() const { return m_running; }
+
+    // The run ended early because the book could not be read or the table
+    // could not grow; the pages published before that stay valid
+    bool hasFailed() const { return m_failed; }
+
+    // Page count extrapolated from the bytes paginated so far
+    int estimatedPageCount() const;
+
+    bool getPage(int page, PageSpan &span) const;
+
+    // Page holding offset, or -1 when pagination has not reached it yet
+    int findPage(uint32_t offset) const;
+
+    // Block until the task has finished or been cancelled
+    void wait();
+
+private:
+    static void taskEntry(void *param);
+    void run();
+    bool publish(uint32_t offset, uint32_t length, uint32_t bytesDone);
+
+    SemaphoreHandle_t m_mutex;
+    TaskHandle_t m_task;
+    String m_path;
+    TextLayout m_layout;
+    PageIndexKey m_key;
+    uint32_t m_anchor;
+
+    PageTable m_pages;
+    uint32_t m_totalBytes;
+    volatile uint32_t m_bytesDone;
+    volatile bool m_running;
+    volatile bool m_cancel;
+    volatile bool m_complete;
+    volatile bool m_failed;
+};
+
+#endif // PAGINATOR_H
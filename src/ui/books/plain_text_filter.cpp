@@ -0,0 +1,125 @@
+#include "plain_text_filter.h"
+
+static const uint8_t UTF8_BOM[] = {0xEF, 0xBB, 0xBF};
+static const char HEADING_PREFIX[] = "chapter ";
+
+PlainTextFilter::PlainTextFilter()
+{
+    reset();
+}
+
+void PlainTextFilter::reset()
+{
+    m_headings.clear();
+    m_total = 0;
+    m_lineStart = 0;
+    m_afterBlank = true;
+    m_pendingSpace = false;
+    m_lastWasCR = false;
+    m_newlines = 0;
+    m_bomMatched = 0;
+    m_lineLength = 0;
+}
+
+size_t PlainTextFilter::feed(const char *in, size_t len, char *out)
+{
+    size_t written = 0;
+
+    for (size_t i = 0; i < len; i++)
+    {
+        uint8_t c = (uint8_t)in[i];
+
+        // A BOM is only looked for at the very start of the text
+        if (m_bomMatched < sizeof(UTF8_BOM) && m_total == 0 && written == 0)
+        {
+            if (c == UTF8_BOM[m_bomMatched])
+            {
+                m_bomMatched++;
+                continue;
+            }
+            for (uint8_t b = 0; b < m_bomMatched; b++)
+            {
+                emit((char)UTF8_BOM[b], out, written);
+            }
+            m_bomMatched = sizeof(UTF8_BOM);
+        }
+
+        bool wasCR = m_lastWasCR;
+        m_lastWasCR = c == '\r';
+
+        if (c == '\n' || c == '\r')
+        {
+            // CRLF is one line break
+            if (c == '\n' && wasCR)
+            {
+                continue;
+            }
+            if (m_newlines < 2)
+            {
+                m_newlines++;
+            }
+            m_pendingSpace = false;
+        }
+        else if (c == ' ' || c == '\t')
+        {
+            // Spaces never start or end a line
+            if (m_newlines == 0 && m_total + written > 0)
+            {
+                m_pendingSpace = true;
+            }
+        }
+        else if (c >= 0x20 && c != 0x7F)
+        {
+            emit((char)c, out, written);
+        }
+    }
+
+    m_total += written;
+    return written;
+}
+
+void PlainTextFilter::emit(char c, char *out, size_t &written)
+{
+    uint32_t offset = m_total + written;
+
+    if (m_newlines > 0 || offset == 0)
+    {
+        // Pending line breaks are only written once text follows them
+        if (offset > 0)
+        {
+            for (uint8_t n = 0; n < m_newlines; n++)
+            {
+                out[written++] = '\n';
+            }
+        }
+        m_afterBlank = m_newlines > 1 || offset == 0;
+        m_newlines = 0;
+        m_lineStart = m_total + written;
+        m_lineLength = 0;
+    }
+    else if (m_pendingSpace)
+    {
+        out[written++] = ' ';
+        remember(' ');
+    }
+    m_pendingSpace = false;
+
+    out[written++] = c;
+    remember(c);
+}
+
+void PlainTextFilter::remember(char c)
+{
+    if (m_lineLength >= sizeof(m_line))
+    {
+        return;
+    }
+    m_line[m_lineLength++] = c;
+
+    // A line starting with "Chapter " after a blank line is a heading
+    if (m_lineLength == sizeof(m_line) && m_afterBlank &&
+        strncasecmp(m_line, HEADING_PREFIX, sizeof(m_line)) == 0)
+    {
+        m_headings.push_back(m_lineStart);
+    }
+}
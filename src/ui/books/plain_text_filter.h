@@ -0,0 +1,40 @@
+#ifndef PLAIN_TEXT_FILTER_H
+#define PLAIN_TEXT_FILTER_H
+
+#include <Arduino.h>
+#include <vector>
+
+// Incremental normalizer for plain text books.
+// Text is fed in arbitrary chunks. Line endings become '\n', tabs become
+// spaces, runs of spaces and of blank lines are collapsed, control
+// characters and a leading UTF-8 BOM are dropped. Lines that look like
+// chapter headings are recorded by their offset in the output.
+class PlainTextFilter
+{
+public:
+    PlainTextFilter();
+    void reset();
+
+    // Normalize len bytes into out, returns bytes written.
+    // out must hold at least len + 2 bytes.
+    size_t feed(const char *in, size_t len, char *out);
+
+    const std::vector<uint32_t> &headings() const { return m_headings; }
+
+private:
+    void emit(char c, char *out, size_t &written);
+    void remember(char c);
+
+    std::vector<uint32_t> m_headings;
+    uint32_t m_total;       // Bytes output since reset
+    uint32_t m_lineStart;   // Output offset of the current line
+    bool m_afterBlank;      // Current line follows a blank line
+    bool m_pendingSpace;
+    bool m_lastWasCR;
+    uint8_t m_newlines;
+    uint8_t m_bomMatched;
+    uint8_t m_lineLength;
+    char m_line[8];         // First bytes of the current line
+};
+
+#endif // PLAIN_TEXT_FILTER_H
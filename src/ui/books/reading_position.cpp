@@ -0,0 +1,101 @@
+#include "reading_position.h"
+#include "page_index.h"
+#include "../../../include/storage.h"
+
+static const char *POSITIONS_PATH = "/cache/positions.dat";
+
+bool ReadingPositions::load(const String &path, uint32_t fileSize, uint32_t &offset)
+{
+    Record records[MAX_BOOKS];
+    int count = readRecords(records);
+    uint32_t pathHash = PageIndex::hash(path.c_str(), path.length());
+
+    for (int i = 0; i < count; i++)
+    {
+        // A different size means the book was replaced and the offset is meaningless
+        if (records[i].pathHash == pathHash && records[i].fileSize == fileSize)
+        {
+            offset = records[i].offset;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ReadingPositions::save(const String &path, uint32_t fileSize, uint32_t offset)
+{
+    if (getSDCardStatus() != SD_READY)
+    {
+        return false;
+    }
+
+    Record records[MAX_BOOKS];
+    int count = readRecords(records);
+    bool exists = count > 0;
+    uint32_t pathHash = PageIndex::hash(path.c_str(), path.length());
+
+    // Reuse the book's record, otherwise append or replace the oldest one
+    int slot = -1;
+    int oldest = 0;
+    uint32_t sequence = 0;
+    for (int i = 0; i < count; i++)
+    {
+        if (records[i].pathHash == pathHash)
+        {
+            slot = i;
+        }
+        if (records[i].sequence < records[oldest].sequence)
+        {
+            oldest = i;
+        }
+        sequence = max(sequence, records[i].sequence);
+    }
+    if (slot < 0)
+    {
+        slot = count < MAX_BOOKS ? count++ : oldest;
+    }
+
+    records[slot].pathHash = pathHash;
+    records[slot].fileSize = fileSize;
+    records[slot].offset = offset;
+    records[slot].sequence = sequence + 1;
+
+    // Only the one record is written; the rest of the file is left alone
+    File file;
+    if (exists)
+    {
+        file = SD.open(POSITIONS_PATH, "r+");
+    }
+    else
+    {
+        createDirectory("/cache");
+        file = SD.open(POSITIONS_PATH, FILE_WRITE);
+    }
+    if (!file || !file.seek(slot * sizeof(Record)))
+    {
+        Serial.println("Failed to save reading position");
+        return false;
+    }
+
+    bool ok = file.write((const uint8_t *)&records[slot], sizeof(Record)) == sizeof(Record);
+    file.close();
+    return ok;
+}
+
+int ReadingPositions::readRecords(Record *records)
+{
+    if (getSDCardStatus() != SD_READY)
+    {
+        return 0;
+    }
+
+    File file = SD.open(POSITIONS_PATH, FILE_READ);
+    if (!file)
+    {
+        return 0;
+    }
+
+    int count = file.read((uint8_t *)records, MAX_BOOKS * sizeof(Record)) / sizeof(Record);
+    file.close();
+    return count;
+}
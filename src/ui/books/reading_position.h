@@ -0,0 +1,29 @@
+#ifndef READING_POSITION_H
+#define READING_POSITION_H
+
+#include <Arduino.h>
+
+// Last reading position of recently opened books, stored on SD.
+// Positions are byte offsets into the book's text rather than page numbers,
+// so they stay valid when the font, margins or line height change.
+class ReadingPositions
+{
+public:
+    static const int MAX_BOOKS = 64;
+
+    static bool load(const String &path, uint32_t fileSize, uint32_t &offset);
+    static bool save(const String &path, uint32_t fileSize, uint32_t offset);
+
+private:
+    struct Record
+    {
+        uint32_t pathHash;
+        uint32_t fileSize;
+        uint32_t offset;
+        uint32_t sequence; // Higher is more recent, the oldest record is replaced first
+    };
+
+    static int readRecords(Record *records);
+};
+
+#endif // READING_POSITION_H
@@ -0,0 +1,200 @@
+#include "text_layout.h"
+
+TextLayout::TextLayout() : m_metrics(FontMetrics::forFont(nullptr))
+{
+    m_left = 0;
+    m_top = 0;
+    m_maxWidth = 0;
+    m_lineHeight = 1;
+    m_linesPerPage = 0;
+}
+
+void TextLayout::configure(const GFXfont *font, int16_t left, int16_t top, int16_t maxWidth, int16_t bottom, int16_t lineHeight)
+{
+    m_metrics = FontMetrics::forFont(font);
+    m_left = left;
+    m_top = top;
+    m_maxWidth = maxWidth;
+    m_lineHeight = lineHeight > 0 ? lineHeight : 1;
+
+    // Baselines run from top to bottom inclusive
+    m_linesPerPage = (bottom - top) / m_lineHeight + 1;
+    m_linesPerPage = constrain(m_linesPerPage, 1, MAX_LINES_PER_PAGE);
+}
+
+uint32_t TextLayout::layoutLine(BookStream &stream, uint32_t offset, LineSpan &line) const
+{
+    uint32_t end = stream.size();
+    uint32_t pos = offset;
+    uint16_t width = 0;
+
+    // Last space on the line, where it can be broken without splitting a word
+    bool hasBreak = false;
+    uint32_t breakPos = 0;
+    uint16_t breakWidth = 0;
+
+    line.start = offset;
+
+    while (pos < end && pos - offset < MAX_LINE_BYTES)
+    {
+        int c = stream.charAt(pos);
+
+        if (c == '\n')
+        {
+            line.length = pos - offset;
+            line.width = width;
+            return pos + 1;
+        }
+
+        if (c == ' ' || c == '\t')
+        {
+            hasBreak = true;
+            breakPos = pos;
+            breakWidth = width;
+            width += m_metrics.advance(' ');
+            pos++;
+            continue;
+        }
+
+        uint8_t advance = m_metrics.advance(c);
+        if (width + advance > m_maxWidth && pos > offset)
+        {
+            if (hasBreak)
+            {
+                line.length = breakPos - offset;
+                line.width = breakWidth;
+                return breakPos + 1;
+            }
+
+            // A single word wider than the line is split where it overflows
+            line.length = pos - offset;
+            line.width = width;
+            return pos;
+        }
+
+        width += advance;
+        pos++;
+    }
+
+    line.length = pos - offset;
+    line.width = width;
+    return pos;
+}
+
+uint32_t TextLayout::layoutPage(BookStream &stream, uint32_t offset, LineSpan *lines, int &lineCount) const
+{
+    uint32_t end = stream.size();
+    uint32_t pos = offset;
+    LineSpan scratch;
+
+    lineCount = 0;
+    while (lineCount < m_linesPerPage && pos < end)
+    {
+        pos = layoutLine(stream, pos, lines ? lines[lineCount] : scratch);
+        lineCount++;
+    }
+    return pos;
+}
+
+void TextLayout::drawLines(Adafruit_GFX &gfx, BookStream &stream, const LineSpan *lines, int lineCount) const
+{
+    // Line breaks are already known, so drawing is just printing each span
+    char buffer[MAX_LINE_BYTES];
+    int16_t y = m_top;
+    for (int i = 0; i < lineCount; i++)
+    {
+        size_t length = stream.read(lines[i].start, buffer, lines[i].length);
+        gfx.setCursor(m_left, y);
+        gfx.write((const uint8_t *)buffer, length);
+        y += m_lineHeight;
+    }
+}
+
+void TextLayout::drawLines(GlyphBlitter &blitter, GFXcanvas1 &canvas, BookStream &stream, const LineSpan *lines,
+                           int lineCount, uint16_t color) const
+{
+    blitter.setFont(m_metrics.font());
+
+    char buffer[MAX_LINE_BYTES];
+    int16_t y = m_top;
+    for (int i = 0; i < lineCount; i++)
+    {
+        size_t length = stream.read(lines[i].start, buffer, lines[i].length);
+        blitter.drawText(canvas, m_left, y, buffer, length, color);
+        y += m_lineHeight;
+    }
+}
+
+uint32_t TextLayout::skipBlank(BookStream &stream, uint32_t offset) const
+{
+    uint32_t end = stream.size();
+    while (offset < end)
+    {
+        int c = stream.charAt(offset);
+        if (c != ' ' && c != '\n' && c != '\r' && c != '\t')
+        {
+            break;
+        }
+        offset++;
+    }
+    return offset;
+}
+
+uint32_t TextLayout::sentenceStart(BookStream &stream, uint32_t offset, uint32_t maxBack) const
+{
+    uint32_t limit = offset > maxBack ? offset - maxBack : 0;
+
+    // A sentence starts after a line break or after ". ", "! " and "? "
+    for (uint32_t pos = offset; pos > limit; pos--)
+    {
+        int c = stream.charAt(pos - 1);
+        if (c == '\n')
+        {
+            return pos;
+        }
+        if (c == ' ' && pos >= 2)
+        {
+            int p = stream.charAt(pos - 2);
+            if (p == '.' || p == '!' || p == '?')
+            {
+                return pos;
+            }
+        }
+    }
+    return limit == 0 ? 0 : offset;
+}
+
+uint32_t TextLayout::previousPageStart(BookStream &stream, uint32_t offset) const
+{
+    // No page holds more than this many bytes, so the window spans at least one
+    uint32_t window = (uint32_t)m_linesPerPage * (MAX_LINE_BYTES + 1);
+    uint32_t start = 0;
+
+    // Line breaks do not depend on where layout started once a paragraph begins
+    if (offset > window)
+    {
+        start = offset - window;
+        while (start < offset && stream.charAt(start) != '\n')
+        {
+            start++;
+        }
+        start = skipBlank(stream, start);
+        if (start >= offset)
+        {
+            start = offset - window;
+        }
+    }
+
+    // The last page starting before offset, cut short where offset begins
+    while (start < offset)
+    {
+        int lineCount = 0;
+        uint32_t next = skipBlank(stream, layoutPage(stream, start, nullptr, lineCount));
+        if (next >= offset || next <= start)
+        {
+            break;
+        }
+        start = next;
+    }
+    return start;
+}
@@ -0,0 +1,71 @@
+#ifndef TEXT_LAYOUT_H
+#define TEXT_LAYOUT_H
+
+#include <Arduino.h>
+#include <Adafruit_GFX.h>
+#include "../../../include/font_metrics.h"
+#include "../../../include/glyph_blitter.h"
+#include "book_stream.h"
+
+// One laid-out line: a byte span of the book and its width in pixels
+struct LineSpan
+{
+    uint32_t start;
+    uint16_t length;
+    uint16_t width;
+};
+
+// Page geometry and greedy word wrapping shared by pagination and drawing.
+// Widths come from the font's advance table, so the lines produced here are
+// exactly the lines that get drawn and pages are filled to the last line.
+class TextLayout
+{
+public:
+    static const int MAX_LINES_PER_PAGE = 48;
+    static const int MAX_LINE_BYTES = 256;
+
+    TextLayout();
+
+    void configure(const GFXfont *font, int16_t left, int16_t top, int16_t maxWidth, int16_t bottom, int16_t lineHeight);
+
+    // Break one line starting at offset, returns the offset of the next line
+    uint32_t layoutLine(BookStream &stream, uint32_t offset, LineSpan &line) const;
+
+    // Lay out one page, returns the offset just past it. lines may be null
+    // when only the page end is needed, otherwise it must hold linesPerPage()
+    uint32_t layoutPage(BookStream &stream, uint32_t offset, LineSpan *lines, int &lineCount) const;
+
+    // Print laid-out lines at their baselines in the font already set on gfx
+    void drawLines(Adafruit_GFX &gfx, BookStream &stream, const LineSpan *lines, int lineCount) const;
+
+    // Same lines written straight into a 1bpp canvas through the glyph cache
+    void drawLines(GlyphBlitter &blitter, GFXcanvas1 &canvas, BookStream &stream, const LineSpan *lines, int lineCount,
+                   uint16_t color) const;
+
+    // Skip blank space between pages so pages never start with empty lines
+    uint32_t skipBlank(BookStream &stream, uint32_t offset) const;
+
+    // Start of the sentence holding offset, or offset when none begins
+    // within maxBack bytes before it
+    uint32_t sentenceStart(BookStream &stream, uint32_t offset, uint32_t maxBack) const;
+
+    // Start of the page ending at offset, laid out locally from a paragraph
+    // start one page window back, without needing the page table
+    uint32_t previousPageStart(BookStream &stream, uint32_t offset) const;
+
+    const FontMetrics &metrics() const { return m_metrics; }
+    int16_t left() const { return m_left; }
+    int16_t top() const { return m_top; }
+    int16_t lineHeight() const { return m_lineHeight; }
+    int linesPerPage() const { return m_linesPerPage; }
+
+private:
+    FontMetrics m_metrics;
+    int16_t m_left;
+    int16_t m_top;
+    int16_t m_maxWidth;
+    int16_t m_lineHeight;
+    int m_linesPerPage;
+};
+
+#endif // TEXT_LAYOUT_H
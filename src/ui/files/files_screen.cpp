@@ -2,6 +2,8 @@
 #include "../../../include/storage.h"
 #include "../../../include/power.h"
 #include "../../../include/display.h"
+#include "../books/book_ingest.h"
+#include "../books/library_catalog.h"
 #include <SD.h>
 #include <algorithm>
 
@@ -33,6 +35,12 @@ void FilesScreen::draw(EinkDisplayManager::DisplayUpdateMode mode)
         refreshCurrentDirectory();
     }
 
+    if (imageViewer.isOpen())
+    {
+        imageViewer.draw(mode);
+        return;
+    }
+
     display.startDrawing();
     drawHeader();
     drawPathBreadcrumb();
@@ -58,6 +66,14 @@ void FilesScreen::draw(EinkDisplayManager::DisplayUpdateMode mode)
 
 void FilesScreen::handleSelectAction()
 {
+    // In the image viewer SELECT switches the dithering kernel and depth
+    if (imageViewer.isOpen())
+    {
+        imageViewer.nextDitherMode();
+        draw(EinkDisplayManager::UPDATE_PARTIAL);
+        return;
+    }
+
     // If global menu is visible, handle menu selection
     if (globalMenu.isVisible)
     {
@@ -98,6 +114,11 @@ void FilesScreen::handleSelectAction()
 
 void FilesScreen::handleDownAction()
 {
+    if (imageViewer.isOpen())
+    {
+        return;
+    }
+
     // If global menu is visible, navigate menu down
     if (globalMenu.isVisible)
     {
@@ -116,8 +137,8 @@ void FilesScreen::handleDownAction()
 
 void FilesScreen::handleQuickDownAction(int steps)
 {
-    // If global menu is visible, ignore quick navigation
-    if (globalMenu.isVisible)
+    // If global menu or an image is shown, ignore quick navigation
+    if (globalMenu.isVisible || imageViewer.isOpen())
     {
         return;
     }
@@ -132,8 +153,8 @@ void FilesScreen::handleQuickDownAction(int steps)
 
 void FilesScreen::handleQuickUpAction(int steps)
 {
-    // If global menu is visible, ignore quick navigation
-    if (globalMenu.isVisible)
+    // If global menu or an image is shown, ignore quick navigation
+    if (globalMenu.isVisible || imageViewer.isOpen())
     {
         return;
     }
@@ -148,6 +169,14 @@ void FilesScreen::handleQuickUpAction(int steps)
 
 void FilesScreen::handleUpAction()
 {
+    // Close the image viewer and return to the list
+    if (imageViewer.isOpen())
+    {
+        imageViewer.close();
+        draw(EinkDisplayManager::UPDATE_FAST);
+        return;
+    }
+
     // If global menu is visible, navigate menu up or close it
     if (globalMenu.isVisible)
     {
@@ -239,12 +268,15 @@ void FilesScreen::deleteSelectedFile()
         }
         else
         {
+            // The converted copy of a book goes with it
+            BookIngest::remove(item.fullPath);
             success = deleteFile(item.fullPath);
         }
 
         if (success)
         {
             Serial.println("[Files] Deleted: " + item.fullPath);
+            LibraryCatalog::markStale();
             refreshCurrentDirectory();
         }
         else
@@ -272,6 +304,11 @@ bool FilesScreen::isAtRoot() const
 
 void FilesScreen::showGlobalMenu()
 {
+    if (imageViewer.isOpen())
+    {
+        return;
+    }
+
     globalMenu.isVisible = true;
     globalMenu.selectedOption = 0;
 
@@ -290,6 +327,10 @@ void FilesScreen::showGlobalMenu()
         else
         {
             globalMenu.title = "File Options";
+            if (isViewableImage(item))
+            {
+                globalMenu.options.push_back("View Image");
+            }
             globalMenu.options.push_back("View File Info");
             globalMenu.options.push_back("Delete File");
         }
@@ -332,6 +373,19 @@ void FilesScreen::handleGlobalMenuSelect()
             hideGlobalMenu();
             deleteSelectedFile();
         }
+        else if (selectedOption == "View Image")
+        {
+            globalMenu.isVisible = false;
+            if (selectedItemIndex >= 0 && selectedItemIndex < currentItems.size() &&
+                imageViewer.open(currentItems[selectedItemIndex].fullPath))
+            {
+                draw(EinkDisplayManager::UPDATE_FULL);
+            }
+            else
+            {
+                draw(EinkDisplayManager::UPDATE_PARTIAL);
+            }
+        }
         else if (selectedOption == "View File Info")
         {
             hideGlobalMenu();
@@ -367,10 +421,6 @@ void FilesScreen::drawHeader()
 {
     extern EinkDisplayManager display;
 
-    // Draw status bar first
-    extern void drawStatusBar();
-    drawStatusBar();
-
     // Draw screen title
     display.m_display.setFont(&FreeMonoBold18pt7b);
     display.drawCenteredText("Files", 50, &FreeMonoBold18pt7b);
@@ -719,6 +769,13 @@ String FilesScreen::getFileIcon(const FileItem &item)
     }
 }
 
+bool FilesScreen::isViewableImage(const FileItem &item)
+{
+    String name = item.name;
+    name.toLowerCase();
+    return !item.isDirectory && name.endsWith(".bmp");
+}
+
 bool FilesScreen::isValidPath(const String &path)
 {
     return !path.isEmpty() && path.startsWith("/");
@@ -3,6 +3,7 @@
 
 #include "../../../include/display.h"
 #include "../../../include/storage.h"
+#include "image_viewer.h"
 #include <vector>
 #include <FS.h>
 #include <SD.h>
@@ -71,6 +72,9 @@ private:
     
     // Global menu dialog
     GlobalMenuDialog globalMenu;
+
+    // Shown instead of the list while an image is open
+    ImageViewer imageViewer;
     
     // Drawing helpers
     void drawHeader();
@@ -83,6 +87,7 @@ private:
     void loadDirectory(const String &path);
     String formatFileSize(size_t bytes);
     String getFileIcon(const FileItem &item);
+    bool isViewableImage(const FileItem &item);
     bool isValidPath(const String &path);
     
     // Navigation helpers
@@ -0,0 +1,277 @@
+#include "image_viewer.h"
+
+// First row below the status bar layer
+static const int16_t IMAGE_TOP = 22;
+
+static uint16_t readLE16(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8);
+}
+
+static uint32_t readLE32(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint8_t luma(uint8_t r, uint8_t g, uint8_t b)
+{
+    return (r * 77 + g * 150 + b * 29) >> 8;
+}
+
+ImageViewer::ImageViewer()
+{
+    m_open = false;
+    m_width = 0;
+    m_height = 0;
+    m_bottomUp = true;
+    m_bpp = 0;
+    m_dataOffset = 0;
+    m_stride = 0;
+    m_kernel = GrayDither::KERNEL_DIFFUSION;
+    m_levels = 2;
+}
+
+bool ImageViewer::open(const String &path)
+{
+    close();
+    m_file = SD.open(path, FILE_READ);
+    if (!m_file)
+    {
+        Serial.println("[Image] Cannot open " + path);
+        return false;
+    }
+
+    m_path = path;
+    if (!readHeader())
+    {
+        close();
+        return false;
+    }
+    m_open = true;
+    Serial.println("[Image] " + path + ": " + String(m_width) + "x" + String(m_height) + ", " + String(m_bpp) + " bpp");
+    return true;
+}
+
+void ImageViewer::close()
+{
+    if (m_file)
+    {
+        m_file.close();
+    }
+    m_open = false;
+    std::vector<uint8_t>().swap(m_raw);
+}
+
+bool ImageViewer::readHeader()
+{
+    uint8_t header[54];
+    if (m_file.read(header, sizeof(header)) != sizeof(header) || header[0] != 'B' || header[1] != 'M')
+    {
+        Serial.println("[Image] Not a BMP file: " + m_path);
+        return false;
+    }
+
+    m_dataOffset = readLE32(header + 10);
+    uint32_t dibSize = readLE32(header + 14);
+    m_width = (int32_t)readLE32(header + 18);
+    int32_t height = (int32_t)readLE32(header + 22);
+    m_bpp = readLE16(header + 28);
+    uint32_t compression = readLE32(header + 30);
+    uint32_t colors = readLE32(header + 46);
+
+    // Rows are stored bottom-up unless the height is negative
+    m_bottomUp = height > 0;
+    m_height = height < 0 ? -height : height;
+
+    // 32 bit bitfield images are taken to use the usual BGRA layout
+    bool uncompressed = compression == 0 || (compression == 3 && m_bpp == 32);
+    bool depth = m_bpp == 1 || m_bpp == 4 || m_bpp == 8 || m_bpp == 24 || m_bpp == 32;
+    if (dibSize < 40 || !uncompressed || !depth || m_width <= 0 || m_width > MAX_SOURCE_WIDTH || m_height == 0)
+    {
+        Serial.println("[Image] Unsupported BMP: " + String(m_bpp) + " bpp, compression " + String(compression));
+        return false;
+    }
+    m_stride = ((m_width * m_bpp + 31) / 32) * 4;
+
+    if (m_bpp <= 8)
+    {
+        uint32_t entries = 1u << m_bpp;
+        if (colors > 0 && colors < entries)
+        {
+            entries = colors;
+        }
+        memset(m_palette, 0, sizeof(m_palette));
+        m_file.seek(14 + dibSize);
+        for (uint32_t i = 0; i < entries; i++)
+        {
+            uint8_t bgrx[4];
+            if (m_file.read(bgrx, sizeof(bgrx)) != sizeof(bgrx))
+            {
+                Serial.println("[Image] Truncated palette");
+                return false;
+            }
+            m_palette[i] = luma(bgrx[2], bgrx[1], bgrx[0]);
+        }
+    }
+
+    m_raw.resize(m_stride);
+    return true;
+}
+
+bool ImageViewer::readRow(int32_t row, uint8_t *gray)
+{
+    uint32_t fileRow = m_bottomUp ? m_height - 1 - row : row;
+    if (!m_file.seek(m_dataOffset + fileRow * m_stride) || m_file.read(m_raw.data(), m_stride) != m_stride)
+    {
+        return false;
+    }
+
+    const uint8_t *p = m_raw.data();
+    switch (m_bpp)
+    {
+    case 1:
+        for (int32_t x = 0; x < m_width; x++)
+            gray[x] = m_palette[(p[x >> 3] >> (7 - (x & 7))) & 0x01];
+        break;
+    case 4:
+        for (int32_t x = 0; x < m_width; x++)
+            gray[x] = m_palette[(p[x >> 1] >> ((x & 1) ? 0 : 4)) & 0x0F];
+        break;
+    case 8:
+        for (int32_t x = 0; x < m_width; x++)
+            gray[x] = m_palette[p[x]];
+        break;
+    default:
+    {
+        int bytes = m_bpp / 8;
+        for (int32_t x = 0; x < m_width; x++, p += bytes)
+            gray[x] = luma(p[2], p[1], p[0]);
+        break;
+    }
+    }
+    return true;
+}
+
+void ImageViewer::blitRow(FrameBuffer &frame, int16_t x, int16_t y, const uint8_t *bits, int16_t width)
+{
+    // x is byte aligned, so in the unrotated frame a row is a copy
+    if (frame.getRotation() == 0)
+    {
+        uint8_t *row = frame.data() + y * ((frame.rawWidth() + 7) / 8) + x / 8;
+        int16_t whole = width / 8;
+        memcpy(row, bits, whole);
+        int16_t rest = width & 7;
+        if (rest)
+        {
+            uint8_t mask = (uint8_t)(0xFF << (8 - rest));
+            row[whole] = (row[whole] & ~mask) | (bits[whole] & mask);
+        }
+        return;
+    }
+
+    for (int16_t i = 0; i < width; i++)
+    {
+        frame.drawPixel(x + i, y, (bits[i >> 3] & (0x80 >> (i & 7))) ? GxEPD_WHITE : GxEPD_BLACK);
+    }
+}
+
+void ImageViewer::draw(EinkDisplayManager::DisplayUpdateMode mode)
+{
+    extern EinkDisplayManager display;
+    if (!m_open)
+        return;
+
+    unsigned long started = millis();
+    display.startDrawing();
+    FrameBuffer &frame = display.m_display;
+
+    // Fit the image below the status bar, never enlarging it
+    int32_t areaWidth = frame.width();
+    int32_t areaHeight = frame.height() - IMAGE_TOP;
+    int32_t width = m_width;
+    int32_t height = m_height;
+    if (width > areaWidth || height > areaHeight)
+    {
+        if ((int64_t)width * areaHeight > (int64_t)height * areaWidth)
+        {
+            height = std::max<int32_t>(1, (int64_t)height * areaWidth / width);
+            width = areaWidth;
+        }
+        else
+        {
+            width = std::max<int32_t>(1, (int64_t)width * areaHeight / height);
+            height = areaHeight;
+        }
+    }
+    int16_t left = ((areaWidth - width) / 2) & ~7;
+    int16_t top = IMAGE_TOP + (areaHeight - height) / 2;
+
+    std::vector<uint8_t> source(m_width);
+    std::vector<uint8_t> gray(width);
+    std::vector<uint8_t> bits((width + 7) / 8);
+    std::vector<uint8_t> lo(m_levels == 4 ? bits.size() : 0);
+    m_dither.begin(width, m_kernel, m_levels);
+
+    bool ok = true;
+    int32_t loaded = -1;
+    for (int32_t y = 0; y < height && ok; y++)
+    {
+        // Nearest source row, averaged across the source columns of each pixel
+        int32_t sourceRow = (int64_t)y * m_height / height;
+        if (sourceRow != loaded)
+        {
+            ok = readRow(sourceRow, source.data());
+            loaded = sourceRow;
+        }
+        for (int32_t x = 0; x < width; x++)
+        {
+            int32_t from = (int64_t)x * m_width / width;
+            int32_t to = std::max<int32_t>(from + 1, (int64_t)(x + 1) * m_width / width);
+            uint32_t sum = 0;
+            for (int32_t sx = from; sx < to; sx++)
+                sum += source[sx];
+            gray[x] = sum / (to - from);
+        }
+        if (m_levels == 4)
+        {
+            m_dither.ditherRow(gray.data(), bits.data(), lo.data());
+            display.writeGrayRow(left, top + y, bits.data(), lo.data(), width);
+        }
+        else
+        {
+            m_dither.ditherRow(gray.data(), bits.data());
+            blitRow(frame, left, top + y, bits.data(), width);
+        }
+    }
+    m_dither.end();
+    frame.markDirty(left, top, width, height);
+
+    if (!ok)
+    {
+        Serial.println("[Image] Read error in " + m_path);
+    }
+    Serial.println("[Image] " + String(width) + "x" + String(height) + " " + GrayDither::kernelName(m_kernel) + " " +
+                   String(m_levels) + "-level dither: " + String(millis() - started) + " ms");
+
+    display.endDrawing();
+    display.update(mode);
+}
+
+void ImageViewer::nextDitherMode()
+{
+    if (m_kernel == GrayDither::KERNEL_ORDERED)
+    {
+        m_kernel = GrayDither::KERNEL_DIFFUSION;
+    }
+    else
+    {
+        m_kernel = GrayDither::KERNEL_ORDERED;
+        m_levels = m_levels == 2 ? 4 : 2;
+    }
+}
+
+void ImageViewer::setDitherMode(GrayDither::Kernel kernel, uint8_t levels)
+{
+    m_kernel = kernel;
+    m_levels = levels;
+}
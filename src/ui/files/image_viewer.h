@@ -0,0 +1,55 @@
+#ifndef IMAGE_VIEWER_H
+#define IMAGE_VIEWER_H
+
+#include <Arduino.h>
+#include <FS.h>
+#include <SD.h>
+#include <vector>
+#include "../../../include/display.h"
+#include "../../../include/gray_dither.h"
+
+// Full-screen viewer for BMP images on SD.
+// The image is decoded one source row at a time, converted to gray, fitted
+// to the panel and dithered straight into the frame, so only a few rows of
+// it are ever in RAM whatever its size. Uncompressed 1, 4, 8, 24 and 32
+// bit images are supported. Each kernel can dither to 1bpp or to four gray
+// levels, so the two can be compared per screen.
+class ImageViewer
+{
+public:
+    static const int32_t MAX_SOURCE_WIDTH = 4096;
+
+    ImageViewer();
+
+    bool open(const String &path);
+    void close();
+    bool isOpen() const { return m_open; }
+
+    void draw(EinkDisplayManager::DisplayUpdateMode mode);
+
+    // Step to the next of the four kernel and gray level combinations
+    void nextDitherMode();
+    void setDitherMode(GrayDither::Kernel kernel, uint8_t levels);
+
+private:
+    bool readHeader();
+    bool readRow(int32_t row, uint8_t *gray);
+    void blitRow(FrameBuffer &frame, int16_t x, int16_t y, const uint8_t *bits, int16_t width);
+
+    File m_file;
+    String m_path;
+    bool m_open;
+    int32_t m_width;
+    int32_t m_height;
+    bool m_bottomUp;
+    uint16_t m_bpp;
+    uint32_t m_dataOffset;
+    uint32_t m_stride;
+    uint8_t m_palette[256]; // Gray of each palette entry
+    GrayDither::Kernel m_kernel;
+    uint8_t m_levels; // 2 or 4
+    GrayDither m_dither;
+    std::vector<uint8_t> m_raw;
+};
+
+#endif // IMAGE_VIEWER_H
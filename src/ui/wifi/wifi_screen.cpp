@@ -3,6 +3,8 @@
 #include "../../../include/power.h"
 #include "../../../include/display.h"
 #include "../../../include/sensors.h"
+#include "../books/book_screen.h"
+#include "../books/library_catalog.h"
 #include <WiFi.h>
 #include <WebServer.h>
 #include <DNSServer.h>
@@ -38,12 +40,16 @@ struct WiFiConfig
 static WiFiConfig savedConfig;
 static bool apModeActive = false;
 static bool webServerRunning = false;
+
+// Uploaded books waiting to be ingested, once their request has been answered
+static std::vector<String> pendingIngest;
 const char *AP_SSID = "E-Reader";
 const char *AP_PASSWORD = "";
 const byte DNS_PORT = 53;
 
 // File upload handling
 File uploadFile;
+String uploadPath;
 
 WiFiScreen::WiFiScreen()
 {
@@ -418,17 +424,24 @@ void WiFiScreen::handleFileUpload()
     if (upload.status == UPLOAD_FILE_START)
     {
         String filename = "/" + upload.filename;
-        Serial.printf("Upload start: %s\n", filename.c_str());
 
-        // Try SD card first, then SPIFFS
+        // Try SD card first, then SPIFFS; books go straight into the library
         if (isSDCardPowered())
         {
+            if (BookScreen::detectBookFormat(filename) != FORMAT_UNKNOWN)
+            {
+                createDirectory("/books");
+                filename = "/books" + filename;
+            }
             uploadFile = SD.open(filename, FILE_WRITE);
+            uploadPath = filename;
         }
         else
         {
             uploadFile = SPIFFS.open(filename, FILE_WRITE);
+            uploadPath = "";
         }
+        Serial.printf("Upload start: %s\n", filename.c_str());
 
         if (!uploadFile)
         {
@@ -448,6 +461,13 @@ void WiFiScreen::handleFileUpload()
         {
             uploadFile.close();
             Serial.printf("Upload complete: %s (%u bytes)\n", upload.filename.c_str(), upload.totalSize);
+            LibraryCatalog::markStale();
+
+            // Converted from update(), so the upload's response is not held up
+            if (uploadPath.startsWith("/books/"))
+            {
+                pendingIngest.push_back(uploadPath);
+            }
         }
     }
 }
@@ -804,10 +824,6 @@ void WiFiScreen::drawHeader()
 {
     extern EinkDisplayManager display;
 
-    // Draw status bar first
-    extern void drawStatusBar();
-    drawStatusBar();
-
     // Draw WiFi screen title with smaller font
     display.m_display.setFont(&FreeMonoBold12pt7b);
     display.drawCenteredText("WiFi Setup", 80, &FreeMonoBold12pt7b);
@@ -1109,6 +1125,18 @@ void WiFiScreen::update()
         dnsServer.processNextRequest();
         webServer.handleClient();
     }
+
+    // One book at a time, each paginated in the background before the next
+    extern BookScreen bookScreen;
+    if (!pendingIngest.empty() && !uploadFile && !bookScreen.isIngesting())
+    {
+        String path = pendingIngest.front();
+        pendingIngest.erase(pendingIngest.begin());
+        if (!bookScreen.ingestBook(path))
+        {
+            Serial.println("Ingest failed, book will be converted on first open: " + path);
+        }
+    }
 }
 
 // Helper functions
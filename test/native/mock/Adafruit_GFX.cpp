@@ -0,0 +1,145 @@
+#include "Adafruit_GFX.h"
+
+Adafruit_GFX::Adafruit_GFX(int16_t w, int16_t h)
+    : WIDTH(w), HEIGHT(h), _width(w), _height(h), cursor_x(0), cursor_y(0), textcolor(0xFFFF), textbgcolor(0xFFFF),
+      wrap(true), rotation(0), gfxFont(nullptr)
+{
+}
+
+void Adafruit_GFX::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
+{
+    for (int16_t i = x; i < x + w; i++)
+    {
+        drawFastVLine(i, y, h, color);
+    }
+}
+
+void Adafruit_GFX::fillScreen(uint16_t color)
+{
+    fillRect(0, 0, _width, _height, color);
+}
+
+void Adafruit_GFX::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color)
+{
+    for (int16_t i = 0; i < w; i++)
+    {
+        writePixel(x + i, y, color);
+    }
+}
+
+void Adafruit_GFX::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color)
+{
+    for (int16_t i = 0; i < h; i++)
+    {
+        writePixel(x, y + i, color);
+    }
+}
+
+void Adafruit_GFX::drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t size)
+{
+    if (!gfxFont)
+    {
+        return;
+    }
+
+    // Custom fonts draw only set bits, most significant bit first, like the library
+    c -= gfxFont->first;
+    const GFXglyph *glyph = &gfxFont->glyph[c];
+    const uint8_t *bitmap = gfxFont->bitmap;
+    uint16_t offset = glyph->bitmapOffset;
+    uint8_t bits = 0;
+    uint8_t bit = 0;
+
+    startWrite();
+    for (uint8_t yy = 0; yy < glyph->height; yy++)
+    {
+        for (uint8_t xx = 0; xx < glyph->width; xx++)
+        {
+            if (!(bit++ & 7))
+            {
+                bits = bitmap[offset++];
+            }
+            if (bits & 0x80)
+            {
+                writePixel(x + glyph->xOffset + xx, y + glyph->yOffset + yy, color);
+            }
+            bits <<= 1;
+        }
+    }
+    endWrite();
+}
+
+size_t Adafruit_GFX::write(uint8_t c)
+{
+    if (!gfxFont)
+    {
+        cursor_x += 6;
+        return 1;
+    }
+
+    if (c == '\n')
+    {
+        cursor_x = 0;
+        cursor_y += gfxFont->yAdvance;
+    }
+    else if (c != '\r' && c >= gfxFont->first && c <= gfxFont->last)
+    {
+        const GFXglyph *glyph = &gfxFont->glyph[c - gfxFont->first];
+        if (glyph->width > 0 && glyph->height > 0)
+        {
+            if (wrap && cursor_x + glyph->xOffset + glyph->width > _width)
+            {
+                cursor_x = 0;
+                cursor_y += gfxFont->yAdvance;
+            }
+            drawChar(cursor_x, cursor_y, c, textcolor, textbgcolor, 1);
+        }
+        cursor_x += glyph->xAdvance;
+    }
+    return 1;
+}
+
+GFXcanvas1::GFXcanvas1(uint16_t w, uint16_t h, bool allocate_buffer) : Adafruit_GFX(w, h)
+{
+    buffer = allocate_buffer ? (uint8_t *)calloc((w + 7) / 8, h) : nullptr;
+}
+
+GFXcanvas1::~GFXcanvas1()
+{
+    free(buffer);
+}
+
+void GFXcanvas1::drawPixel(int16_t x, int16_t y, uint16_t color)
+{
+    if (!buffer || x < 0 || y < 0 || x >= _width || y >= _height)
+    {
+        return;
+    }
+
+    uint8_t *ptr = &buffer[(x / 8) + y * ((WIDTH + 7) / 8)];
+    if (color)
+    {
+        *ptr |= 0x80 >> (x & 7);
+    }
+    else
+    {
+        *ptr &= ~(0x80 >> (x & 7));
+    }
+}
+
+void GFXcanvas1::fillScreen(uint16_t color)
+{
+    if (buffer)
+    {
+        memset(buffer, color ? 0xFF : 0x00, ((WIDTH + 7) / 8) * HEIGHT);
+    }
+}
+
+bool GFXcanvas1::getPixel(int16_t x, int16_t y) const
+{
+    if (!buffer || x < 0 || y < 0 || x >= _width || y >= _height)
+    {
+        return false;
+    }
+    return buffer[(x / 8) + y * ((WIDTH + 7) / 8)] & (0x80 >> (x & 7));
+}
@@ -0,0 +1,77 @@
+#include "Arduino.h"
+#include "alloc_counter.h"
+#include <chrono>
+#include <thread>
+
+HardwareSerial Serial;
+EspClass ESP;
+
+static const std::chrono::steady_clock::time_point s_start = std::chrono::steady_clock::now();
+
+std::string String::format(long long value, unsigned char base)
+{
+    char text[72];
+    if (base == HEX)
+    {
+        snprintf(text, sizeof(text), "%llx", (unsigned long long)value);
+    }
+    else
+    {
+        snprintf(text, sizeof(text), "%lld", value);
+    }
+    return text;
+}
+
+std::string String::format(double value, unsigned int decimals)
+{
+    char text[64];
+    snprintf(text, sizeof(text), "%.*f", (int)decimals, value);
+    return text;
+}
+
+size_t Print::printf(const char *format, ...)
+{
+    char text[256];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(text, sizeof(text), format, args);
+    va_end(args);
+    return length > 0 ? write((const uint8_t *)text, std::min((size_t)length, sizeof(text) - 1)) : 0;
+}
+
+unsigned long millis()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - s_start).count();
+}
+
+unsigned long micros()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - s_start).count();
+}
+
+void delay(unsigned long ms)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void yield()
+{
+    std::this_thread::yield();
+}
+
+void *ps_malloc(size_t size)
+{
+    countAllocation();
+    return malloc(size);
+}
+
+void *ps_realloc(void *ptr, size_t size)
+{
+    countAllocation();
+    return realloc(ptr, size);
+}
+
+bool psramFound()
+{
+    return true;
+}
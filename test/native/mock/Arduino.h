@@ -0,0 +1,168 @@
+#ifndef NATIVE_ARDUINO_H
+#define NATIVE_ARDUINO_H
+
+// Minimal Arduino core for host builds of the reader modules.
+// Only what the layout, pagination and storage code uses is provided;
+// Serial goes to stdout and PSRAM allocations to the host heap.
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <strings.h>
+
+using std::max;
+using std::min;
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define PROGMEM
+#define F(x) x
+#define pgm_read_byte(addr) (*(const uint8_t *)(addr))
+#define pgm_read_word(addr) (*(const uint16_t *)(addr))
+#define pgm_read_dword(addr) (*(const uint32_t *)(addr))
+#define pgm_read_ptr(addr) (*(void *const *)(addr))
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+#define HEX 16
+#define DEC 10
+
+class String
+{
+public:
+    String() {}
+    String(const char *text) : m_text(text ? text : "") {}
+    String(const std::string &text) : m_text(text) {}
+    String(char c) : m_text(1, c) {}
+    String(int value, unsigned char base = DEC) : m_text(format(value, base)) {}
+    String(unsigned int value, unsigned char base = DEC) : m_text(format(value, base)) {}
+    String(long value, unsigned char base = DEC) : m_text(format(value, base)) {}
+    String(unsigned long value, unsigned char base = DEC) : m_text(format(value, base)) {}
+    String(float value, unsigned int decimals = 2) : m_text(format(value, decimals)) {}
+    String(double value, unsigned int decimals = 2) : m_text(format(value, decimals)) {}
+
+    unsigned int length() const { return m_text.size(); }
+    const char *c_str() const { return m_text.c_str(); }
+    bool isEmpty() const { return m_text.empty(); }
+    char charAt(unsigned int index) const { return index < m_text.size() ? m_text[index] : 0; }
+    char operator[](unsigned int index) const { return charAt(index); }
+
+    String substring(unsigned int from) const { return from < m_text.size() ? String(m_text.substr(from)) : String(); }
+    String substring(unsigned int from, unsigned int to) const
+    {
+        return from < m_text.size() && to > from ? String(m_text.substr(from, to - from)) : String();
+    }
+
+    int indexOf(char c, unsigned int from = 0) const { return position(m_text.find(c, from)); }
+    int indexOf(const String &text, unsigned int from = 0) const { return position(m_text.find(text.m_text, from)); }
+    int lastIndexOf(char c) const { return position(m_text.rfind(c)); }
+
+    bool startsWith(const String &prefix) const { return m_text.compare(0, prefix.m_text.size(), prefix.m_text) == 0; }
+    bool endsWith(const String &suffix) const
+    {
+        return m_text.size() >= suffix.m_text.size() &&
+               m_text.compare(m_text.size() - suffix.m_text.size(), suffix.m_text.size(), suffix.m_text) == 0;
+    }
+    bool equalsIgnoreCase(const String &other) const { return strcasecmp(c_str(), other.c_str()) == 0; }
+    void toLowerCase()
+    {
+        for (char &c : m_text)
+        {
+            c = tolower((unsigned char)c);
+        }
+    }
+    long toInt() const { return atol(c_str()); }
+
+    String &operator+=(const String &other)
+    {
+        m_text += other.m_text;
+        return *this;
+    }
+    bool operator==(const String &other) const { return m_text == other.m_text; }
+    bool operator!=(const String &other) const { return m_text != other.m_text; }
+    bool operator<(const String &other) const { return m_text < other.m_text; }
+
+    friend String operator+(const String &a, const String &b) { return String(a.m_text + b.m_text); }
+    friend String operator+(const String &a, const char *b) { return String(a.m_text + b); }
+    friend String operator+(const char *a, const String &b) { return String(a + b.m_text); }
+
+private:
+    static int position(size_t pos) { return pos == std::string::npos ? -1 : (int)pos; }
+    static std::string format(long long value, unsigned char base);
+    static std::string format(double value, unsigned int decimals);
+
+    std::string m_text;
+};
+
+class Print
+{
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t *buffer, size_t size)
+    {
+        size_t n = 0;
+        while (size--)
+        {
+            n += write(*buffer++);
+        }
+        return n;
+    }
+    size_t write(const char *buffer, size_t size) { return write((const uint8_t *)buffer, size); }
+
+    size_t print(const String &text) { return write((const uint8_t *)text.c_str(), text.length()); }
+    size_t print(const char *text) { return write((const uint8_t *)text, strlen(text)); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(int value) { return print(String(value)); }
+    size_t print(unsigned int value) { return print(String(value)); }
+    size_t print(long value) { return print(String(value)); }
+    size_t print(unsigned long value) { return print(String(value)); }
+    size_t print(double value, int decimals = 2) { return print(String(value, decimals)); }
+    size_t println(const String &text = String()) { return print(text) + print('\n'); }
+    size_t printf(const char *format, ...) __attribute__((format(printf, 2, 3)));
+};
+
+class Stream : public Print
+{
+public:
+    virtual int available() { return 0; }
+    virtual int read() { return -1; }
+    virtual int peek() { return -1; }
+};
+
+class HardwareSerial : public Stream
+{
+public:
+    void begin(unsigned long) {}
+    size_t write(uint8_t c) override { return fputc(c, stdout) == EOF ? 0 : 1; }
+    using Print::write;
+};
+
+extern HardwareSerial Serial;
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void yield();
+
+// PSRAM is the host heap; allocations are counted like operator new
+void *ps_malloc(size_t size);
+void *ps_realloc(void *ptr, size_t size);
+bool psramFound();
+
+class EspClass
+{
+public:
+    uint32_t getFreeHeap() { return 256 * 1024; }
+    uint32_t getFreePsram() { return 4 * 1024 * 1024; }
+};
+
+extern EspClass ESP;
+
+#endif // NATIVE_ARDUINO_H
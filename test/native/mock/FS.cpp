@@ -0,0 +1,205 @@
+#include "FS.h"
+#include "SD.h"
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+SDFS SD;
+SPIClass SPI;
+
+namespace fs
+{
+
+struct FileHandle
+{
+    FILE *file = nullptr;
+    DIR *dir = nullptr;
+    std::string hostPath;
+    std::string path;
+
+    ~FileHandle()
+    {
+        if (file)
+        {
+            fclose(file);
+        }
+        if (dir)
+        {
+            closedir(dir);
+        }
+    }
+};
+
+static std::shared_ptr<FileHandle> openHandle(const std::string &hostPath, const std::string &path, const char *mode)
+{
+    auto handle = std::make_shared<FileHandle>();
+    handle->hostPath = hostPath;
+    handle->path = path;
+
+    struct stat st;
+    if (stat(hostPath.c_str(), &st) == 0 && S_ISDIR(st.st_mode))
+    {
+        handle->dir = opendir(hostPath.c_str());
+        return handle->dir ? handle : nullptr;
+    }
+
+    const char *hostMode = "rb";
+    if (mode[0] == 'w')
+    {
+        hostMode = "wb";
+    }
+    else if (mode[0] == 'a')
+    {
+        hostMode = "ab";
+    }
+    else if (mode[1] == '+')
+    {
+        hostMode = "r+b";
+    }
+
+    handle->file = fopen(hostPath.c_str(), hostMode);
+    return handle->file ? handle : nullptr;
+}
+
+size_t File::write(uint8_t c)
+{
+    return write(&c, 1);
+}
+
+size_t File::write(const uint8_t *buffer, size_t size)
+{
+    return m_handle && m_handle->file ? fwrite(buffer, 1, size, m_handle->file) : 0;
+}
+
+int File::available()
+{
+    return m_handle && m_handle->file ? (int)(size() - position()) : 0;
+}
+
+int File::read()
+{
+    return m_handle && m_handle->file ? fgetc(m_handle->file) : -1;
+}
+
+size_t File::read(uint8_t *buffer, size_t size)
+{
+    return m_handle && m_handle->file ? fread(buffer, 1, size, m_handle->file) : 0;
+}
+
+bool File::seek(uint32_t pos, SeekMode mode)
+{
+    return m_handle && m_handle->file && fseek(m_handle->file, pos, mode) == 0;
+}
+
+size_t File::position() const
+{
+    return m_handle && m_handle->file ? ftell(m_handle->file) : 0;
+}
+
+size_t File::size() const
+{
+    if (!m_handle || !m_handle->file)
+    {
+        return 0;
+    }
+    fflush(m_handle->file);
+    struct stat st;
+    return fstat(fileno(m_handle->file), &st) == 0 ? st.st_size : 0;
+}
+
+void File::flush()
+{
+    if (m_handle && m_handle->file)
+    {
+        fflush(m_handle->file);
+    }
+}
+
+void File::close()
+{
+    m_handle.reset();
+}
+
+time_t File::getLastWrite()
+{
+    struct stat st;
+    return m_handle && stat(m_handle->hostPath.c_str(), &st) == 0 ? st.st_mtime : 0;
+}
+
+const char *File::name() const
+{
+    if (!m_handle)
+    {
+        return "";
+    }
+    size_t slash = m_handle->path.rfind('/');
+    return m_handle->path.c_str() + (slash == std::string::npos ? 0 : slash + 1);
+}
+
+const char *File::path() const
+{
+    return m_handle ? m_handle->path.c_str() : "";
+}
+
+bool File::isDirectory() const
+{
+    return m_handle && m_handle->dir;
+}
+
+File File::openNextFile(const char *mode)
+{
+    if (!m_handle || !m_handle->dir)
+    {
+        return File();
+    }
+
+    struct dirent *entry;
+    while ((entry = readdir(m_handle->dir)) != nullptr)
+    {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
+        {
+            continue;
+        }
+        std::string path = m_handle->path + (m_handle->path == "/" ? "" : "/") + entry->d_name;
+        return File(openHandle(m_handle->hostPath + "/" + entry->d_name, path, mode));
+    }
+    return File();
+}
+
+File::operator bool() const
+{
+    return m_handle != nullptr;
+}
+
+File FS::open(const String &path, const char *mode, bool create)
+{
+    return File(openHandle(hostPath(path), path.c_str(), mode));
+}
+
+bool FS::exists(const String &path)
+{
+    struct stat st;
+    return stat(hostPath(path).c_str(), &st) == 0;
+}
+
+bool FS::remove(const String &path)
+{
+    return ::remove(hostPath(path).c_str()) == 0;
+}
+
+bool FS::rename(const String &from, const String &to)
+{
+    return ::rename(hostPath(from).c_str(), hostPath(to).c_str()) == 0;
+}
+
+bool FS::mkdir(const String &path)
+{
+    return ::mkdir(hostPath(path).c_str(), 0755) == 0;
+}
+
+bool FS::rmdir(const String &path)
+{
+    return ::rmdir(hostPath(path).c_str()) == 0;
+}
+
+} // namespace fs
@@ -0,0 +1,78 @@
+#ifndef NATIVE_FS_H
+#define NATIVE_FS_H
+
+#include "Arduino.h"
+#include <memory>
+
+#define FILE_READ "r"
+#define FILE_WRITE "w"
+#define FILE_APPEND "a"
+
+namespace fs
+{
+
+enum SeekMode
+{
+    SeekSet = 0,
+    SeekCur = 1,
+    SeekEnd = 2
+};
+
+struct FileHandle;
+
+// POSIX-backed file with the Arduino-ESP32 fs::File interface; copies share
+// one open handle, as they do on the device
+class File : public Stream
+{
+public:
+    File() {}
+    explicit File(std::shared_ptr<FileHandle> handle) : m_handle(handle) {}
+
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t *buffer, size_t size) override;
+    using Print::write;
+    int available() override;
+    int read() override;
+    size_t read(uint8_t *buffer, size_t size);
+    bool seek(uint32_t pos, SeekMode mode = SeekSet);
+    size_t position() const;
+    size_t size() const;
+    void flush();
+    void close();
+    time_t getLastWrite();
+    const char *name() const;
+    const char *path() const;
+    bool isDirectory() const;
+    File openNextFile(const char *mode = FILE_READ);
+    operator bool() const;
+
+private:
+    std::shared_ptr<FileHandle> m_handle;
+};
+
+// File system rooted at a host directory, which stands in for the card
+class FS
+{
+public:
+    void setRoot(const std::string &root) { m_root = root; }
+    const std::string &root() const { return m_root; }
+
+    File open(const String &path, const char *mode = FILE_READ, bool create = false);
+    bool exists(const String &path);
+    bool remove(const String &path);
+    bool rename(const String &from, const String &to);
+    bool mkdir(const String &path);
+    bool rmdir(const String &path);
+
+private:
+    std::string hostPath(const String &path) const { return m_root + path.c_str(); }
+
+    std::string m_root = ".";
+};
+
+} // namespace fs
+
+using fs::File;
+using fs::FS;
+
+#endif // NATIVE_FS_H
@@ -0,0 +1,16 @@
+#ifndef NATIVE_SD_H
+#define NATIVE_SD_H
+
+#include "FS.h"
+#include "SPI.h"
+
+class SDFS : public fs::FS
+{
+public:
+    bool begin(uint8_t ssPin = 0, SPIClass &spi = SPI, uint32_t frequency = 4000000) { return true; }
+    void end() {}
+};
+
+extern SDFS SD;
+
+#endif // NATIVE_SD_H
@@ -0,0 +1,12 @@
+#ifndef NATIVE_ALLOC_COUNTER_H
+#define NATIVE_ALLOC_COUNTER_H
+
+#include <stdint.h>
+
+// Heap allocations made through operator new and the ps_* allocators since
+// the program started, from any thread
+uint32_t allocationCount();
+
+void countAllocation();
+
+#endif // NATIVE_ALLOC_COUNTER_H
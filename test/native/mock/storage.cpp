@@ -0,0 +1,46 @@
+#include "../../../include/storage.h"
+
+// The storage functions the reader modules use, on top of the host-backed SD
+
+SDCardStatus getSDCardStatus()
+{
+    return SD_READY;
+}
+
+bool createFile(const String &filename)
+{
+    File file = SD.open(filename, FILE_WRITE);
+    return (bool)file;
+}
+
+bool deleteFile(const String &filename)
+{
+    return SD.remove(filename);
+}
+
+bool fileExists(const String &filename)
+{
+    return SD.exists(filename);
+}
+
+size_t getFileSize(const String &filename)
+{
+    File file = SD.open(filename, FILE_READ);
+    return file ? file.size() : 0;
+}
+
+bool createDirectory(const String &dirPath)
+{
+    return SD.exists(dirPath) || SD.mkdir(dirPath);
+}
+
+bool directoryExists(const String &dirPath)
+{
+    File dir = SD.open(dirPath, FILE_READ);
+    return dir && dir.isDirectory();
+}
+
+bool isSDCardPowered()
+{
+    return true;
+}
@@ -0,0 +1,149 @@
+// Host benchmarks of GrayDither at 1bpp and at four gray levels.
+// Run with: pio test -e native -v
+// Each kernel dithers a full-screen image below the status bar; flat gray
+// fields check that every depth keeps the source tone.
+
+#include <unity.h>
+#include <vector>
+#include "../../../include/gray_dither.h"
+
+// Image area of the viewer on the 240x416 panel
+static const uint16_t IMAGE_WIDTH = 240;
+static const uint16_t IMAGE_HEIGHT = 416 - 22;
+
+// Passes over the image per timing
+static const int REPEATS = 50;
+
+static const GrayDither::Kernel KERNELS[] = {GrayDither::KERNEL_ORDERED, GrayDither::KERNEL_DIFFUSION};
+static const uint8_t LEVELS[] = {2, 4};
+
+// Mean brightness 0..255 of one dithered row at either depth
+static double rowTone(const uint8_t *hi, const uint8_t *lo, uint16_t width)
+{
+    uint32_t sum = 0;
+    for (uint16_t x = 0; x < width; x++)
+    {
+        uint8_t mask = 0x80 >> (x & 7);
+        int level = (hi[x >> 3] & mask) ? 1 : 0;
+        if (lo)
+        {
+            level = level * 2 + ((lo[x >> 3] & mask) ? 1 : 0);
+        }
+        sum += level * 255 / (lo ? 3 : 1);
+    }
+    return (double)sum / width;
+}
+
+// Mean tone of a flat field of gray dithered with the kernel and depth
+static double fieldTone(GrayDither::Kernel kernel, uint8_t levels, uint8_t value)
+{
+    std::vector<uint8_t> gray(IMAGE_WIDTH, value);
+    std::vector<uint8_t> hi((IMAGE_WIDTH + 7) / 8);
+    std::vector<uint8_t> lo(hi.size());
+    GrayDither dither;
+    dither.begin(IMAGE_WIDTH, kernel, levels);
+
+    double total = 0;
+    const int rows = 64;
+    for (int y = 0; y < rows; y++)
+    {
+        if (levels == 4)
+        {
+            dither.ditherRow(gray.data(), hi.data(), lo.data());
+            total += rowTone(hi.data(), lo.data(), IMAGE_WIDTH);
+        }
+        else
+        {
+            dither.ditherRow(gray.data(), hi.data());
+            total += rowTone(hi.data(), nullptr, IMAGE_WIDTH);
+        }
+    }
+    dither.end();
+    return total / rows;
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+void test_tone()
+{
+    for (GrayDither::Kernel kernel : KERNELS)
+    {
+        for (uint8_t levels : LEVELS)
+        {
+            for (int value = 0; value <= 255; value += 17)
+            {
+                // Within one step of a 4x4 Bayer cell
+                TEST_ASSERT_FLOAT_WITHIN(16.0, value, fieldTone(kernel, levels, value));
+            }
+        }
+    }
+
+    // Levels 1 and 2 of four are exact for their own gray, without a pattern
+    std::vector<uint8_t> gray(IMAGE_WIDTH, 85);
+    std::vector<uint8_t> hi((IMAGE_WIDTH + 7) / 8);
+    std::vector<uint8_t> lo(hi.size());
+    GrayDither dither;
+    dither.begin(IMAGE_WIDTH, GrayDither::KERNEL_ORDERED, 4);
+    dither.ditherRow(gray.data(), hi.data(), lo.data());
+    for (size_t i = 0; i < hi.size(); i++)
+    {
+        TEST_ASSERT_EQUAL_HEX8(0x00, hi[i]);
+        TEST_ASSERT_EQUAL_HEX8(0xFF, lo[i]);
+    }
+}
+
+void test_speed()
+{
+    // A diagonal ramp, so every level and threshold is exercised
+    std::vector<uint8_t> image(IMAGE_WIDTH * IMAGE_HEIGHT);
+    for (uint16_t y = 0; y < IMAGE_HEIGHT; y++)
+    {
+        for (uint16_t x = 0; x < IMAGE_WIDTH; x++)
+        {
+            image[y * IMAGE_WIDTH + x] = (x + y) * 255 / (IMAGE_WIDTH + IMAGE_HEIGHT - 2);
+        }
+    }
+    std::vector<uint8_t> hi((IMAGE_WIDTH + 7) / 8);
+    std::vector<uint8_t> lo(hi.size());
+
+    for (GrayDither::Kernel kernel : KERNELS)
+    {
+        double perImage[2];
+        for (int depth = 0; depth < 2; depth++)
+        {
+            uint8_t levels = LEVELS[depth];
+            GrayDither dither;
+            unsigned long start = micros();
+            for (int pass = 0; pass < REPEATS; pass++)
+            {
+                dither.begin(IMAGE_WIDTH, kernel, levels);
+                for (uint16_t y = 0; y < IMAGE_HEIGHT; y++)
+                {
+                    if (levels == 4)
+                        dither.ditherRow(&image[y * IMAGE_WIDTH], hi.data(), lo.data());
+                    else
+                        dither.ditherRow(&image[y * IMAGE_WIDTH], hi.data());
+                }
+                dither.end();
+            }
+            perImage[depth] = (double)(micros() - start) / REPEATS;
+        }
+        printf("%-9s %-9s %ux%u %8.1f us/image 1bpp, %8.1f us/image 4-level, %4.2fx\n", "dither",
+               GrayDither::kernelName(kernel), IMAGE_WIDTH, IMAGE_HEIGHT, perImage[0], perImage[1],
+               perImage[1] / perImage[0]);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_tone);
+    RUN_TEST(test_speed);
+    return UNITY_END();
+}
@@ -0,0 +1,546 @@
+// Host benchmarks of the reader's layout, render and pagination paths.
+// Run with: pio test -e native -v
+// Books are generated into a temporary directory; set READER_BENCH_CORPUS to
+// a directory of .txt files to benchmark those as well.
+
+#include <unity.h>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include "alloc_counter.h"
+#include "../../../include/glyph_blitter.h"
+#include "../../../src/ui/books/book_stream.h"
+#include "../../../src/ui/books/page_cache.h"
+#include "../../../src/ui/books/paginator.h"
+#include "../../../src/ui/books/text_layout.h"
+
+namespace stdfs = std::filesystem;
+
+// Reader geometry, as in BookScreen::configureLayout on the 240x416 panel
+static const int16_t PAGE_WIDTH = 240;
+static const int16_t PAGE_HEIGHT = 416;
+static const int16_t MARGIN = 10;
+static const int16_t TOP = 45;
+static const int16_t BOTTOM = PAGE_HEIGHT - 30;
+
+// Pages drawn per book and font; rendering cost does not depend on position
+static const int RENDER_PAGES = 200;
+
+// Stand-ins for the bundled FreeMono fonts with the same advances and line
+// heights, so pagination matches the device, and glyph boxes of similar
+// size and ink coverage, so render cost is comparable
+struct BenchFont
+{
+    const char *name;
+    uint8_t xAdvance;
+    uint8_t yAdvance;
+    uint8_t lineHeight;
+    uint8_t glyphWidth;
+    uint8_t glyphHeight;
+    std::vector<uint8_t> bitmap;
+    std::vector<GFXglyph> glyphs;
+    GFXfont font;
+};
+
+static BenchFont s_fonts[] = {
+    {"FreeMono9pt7b", 11, 18, 14, 7, 10, {}, {}, {}},
+    {"FreeMono12pt7b", 14, 24, 18, 9, 14, {}, {}, {}},
+    {"FreeMono18pt7b", 21, 35, 24, 14, 20, {}, {}, {}},
+};
+
+struct BenchBook
+{
+    std::string name;
+    String path;
+    size_t size;
+};
+
+static std::vector<BenchBook> s_books;
+static uint32_t s_seed = 12345;
+
+static uint32_t nextRandom()
+{
+    s_seed = s_seed * 1103515245u + 12345u;
+    return s_seed >> 8;
+}
+
+static void buildFont(BenchFont &bench)
+{
+    const uint16_t first = 0x20;
+    const uint16_t last = 0x7E;
+    for (uint16_t c = first; c <= last; c++)
+    {
+        GFXglyph glyph;
+        glyph.bitmapOffset = bench.bitmap.size();
+        glyph.width = c == ' ' ? 0 : bench.glyphWidth;
+        glyph.height = c == ' ' ? 0 : bench.glyphHeight;
+        glyph.xAdvance = bench.xAdvance;
+        glyph.xOffset = (bench.xAdvance - bench.glyphWidth) / 2;
+        glyph.yOffset = 1 - bench.glyphHeight;
+        bench.glyphs.push_back(glyph);
+
+        // About 40% of the glyph box is ink, as in the FreeMono outlines
+        int bytes = (glyph.width * glyph.height + 7) / 8;
+        for (int i = 0; i < bytes; i++)
+        {
+            uint8_t bits = 0;
+            for (int b = 0; b < 8; b++)
+            {
+                bits = (bits << 1) | (nextRandom() % 10 < 4);
+            }
+            bench.bitmap.push_back(bits);
+        }
+    }
+    bench.font = {bench.bitmap.data(), bench.glyphs.data(), first, last, bench.yAdvance};
+}
+
+static std::string randomWord(int minLength, int maxLength)
+{
+    static const char *letters = "etaoinshrdlcumwfgypbvkjxqz";
+    int length = minLength + nextRandom() % (maxLength - minLength + 1);
+    std::string word;
+    for (int i = 0; i < length; i++)
+    {
+        // Skewed towards frequent letters
+        word += letters[(nextRandom() % 26) * (nextRandom() % 26) / 26];
+    }
+    return word;
+}
+
+// Novel-like prose: paragraphs of several sentences
+static std::string makeProse(size_t size)
+{
+    std::string text;
+    while (text.size() < size)
+    {
+        int sentences = 3 + nextRandom() % 6;
+        for (int s = 0; s < sentences; s++)
+        {
+            int words = 6 + nextRandom() % 18;
+            for (int w = 0; w < words; w++)
+            {
+                std::string word = randomWord(1, 10);
+                if (w == 0)
+                {
+                    word[0] = toupper(word[0]);
+                }
+                text += word;
+                text += w == words - 1 ? (nextRandom() % 8 == 0 ? "?" : ".") : (nextRandom() % 12 == 0 ? ", " : " ");
+            }
+            text += ' ';
+        }
+        text += "\n\n";
+    }
+    return text;
+}
+
+// Verse: short lines and stanza breaks, many forced line ends per page
+static std::string makeVerse(size_t size)
+{
+    std::string text;
+    while (text.size() < size)
+    {
+        int lines = 2 + nextRandom() % 5;
+        for (int l = 0; l < lines; l++)
+        {
+            int words = 2 + nextRandom() % 5;
+            for (int w = 0; w < words; w++)
+            {
+                text += randomWord(2, 8);
+                text += w == words - 1 ? "\n" : " ";
+            }
+        }
+        text += '\n';
+    }
+    return text;
+}
+
+// Technical text: long unbreakable tokens that force words to be split
+static std::string makeDense(size_t size)
+{
+    std::string text;
+    while (text.size() < size)
+    {
+        int words = 40 + nextRandom() % 80;
+        for (int w = 0; w < words; w++)
+        {
+            text += nextRandom() % 6 == 0 ? "https://example.org/" + randomWord(20, 40) : randomWord(4, 14);
+            text += ' ';
+        }
+        text += '\n';
+    }
+    return text;
+}
+
+static void addBook(const stdfs::path &root, const std::string &name, const std::string &text)
+{
+    FILE *file = fopen((root / "books" / name).string().c_str(), "wb");
+    TEST_ASSERT_NOT_NULL(file);
+    fwrite(text.data(), 1, text.size(), file);
+    fclose(file);
+    s_books.push_back({name, String(("/books/" + name).c_str()), text.size()});
+}
+
+static void configureLayout(TextLayout &layout, const BenchFont &bench)
+{
+    layout.configure(&bench.font, MARGIN, TOP, PAGE_WIDTH - 2 * MARGIN, BOTTOM, bench.lineHeight);
+}
+
+static void report(const char *what, const BenchBook &book, const BenchFont &font, int pages, size_t bytes,
+                   unsigned long elapsedUs, uint32_t allocations)
+{
+    double seconds = elapsedUs > 0 ? elapsedUs / 1e6 : 1e-6;
+    printf("%-9s %-12s %-15s %6d pages %9.0f pages/s %8.2f MB/s %6.3f allocs/page\n", what, book.name.c_str(),
+           font.name, pages, pages / seconds, bytes / seconds / (1024.0 * 1024.0),
+           pages > 0 ? (double)allocations / pages : 0.0);
+}
+
+// Page breaks only, as during pagination but on the calling thread
+static int layoutBook(BookStream &stream, const TextLayout &layout)
+{
+    PageLines lines;
+    int pages = 0;
+    uint32_t pos = layout.skipBlank(stream, 0);
+    while (pos < stream.size())
+    {
+        lines.end = layout.layoutPage(stream, pos, lines.lines, lines.lineCount);
+        pos = layout.skipBlank(stream, lines.end);
+        pages++;
+    }
+    return pages;
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+void test_layout()
+{
+    for (const BenchBook &book : s_books)
+    {
+        for (const BenchFont &font : s_fonts)
+        {
+            TextLayout layout;
+            configureLayout(layout, font);
+            BookStream stream;
+            TEST_ASSERT_TRUE(stream.open(book.path));
+
+            uint32_t allocations = allocationCount();
+            unsigned long start = micros();
+            int pages = layoutBook(stream, layout);
+            unsigned long elapsed = micros() - start;
+            allocations = allocationCount() - allocations;
+
+            report("layout", book, font, pages, stream.size(), elapsed, allocations);
+            TEST_ASSERT_GREATER_THAN(0, pages);
+
+            // Laying out a page must never touch the heap
+            TEST_ASSERT_EQUAL_UINT32(0, allocations);
+        }
+    }
+}
+
+void test_render()
+{
+    GFXcanvas1 canvas(PAGE_WIDTH, PAGE_HEIGHT);
+    GFXcanvas1 reference(PAGE_WIDTH, PAGE_HEIGHT);
+    const size_t frameBytes = ((PAGE_WIDTH + 7) / 8) * PAGE_HEIGHT;
+    PageLines lines;
+
+    for (const BenchBook &book : s_books)
+    {
+        for (const BenchFont &font : s_fonts)
+        {
+            TextLayout layout;
+            configureLayout(layout, font);
+            BookStream stream;
+            TEST_ASSERT_TRUE(stream.open(book.path));
+
+            canvas.setFont(&font.font);
+            canvas.setTextColor(0);
+            canvas.setTextWrap(false);
+
+            // The glyph cache is built once per font, outside the timed loop
+            GlyphBlitter blitter;
+            TEST_ASSERT_TRUE(blitter.setFont(&font.font));
+
+            // Lines are laid out beforehand, as the page cache does, so only drawing is timed
+            unsigned long gfxElapsed = 0;
+            unsigned long blitElapsed = 0;
+            uint32_t allocations = 0;
+            size_t bytes = 0;
+            int pages = 0;
+            uint32_t pos = layout.skipBlank(stream, 0);
+            while (pos < stream.size() && pages < RENDER_PAGES)
+            {
+                lines.end = layout.layoutPage(stream, pos, lines.lines, lines.lineCount);
+
+                uint32_t before = allocationCount();
+                unsigned long start = micros();
+                canvas.fillScreen(1);
+                layout.drawLines(canvas, stream, lines.lines, lines.lineCount);
+                gfxElapsed += micros() - start;
+                memcpy(reference.getBuffer(), canvas.getBuffer(), frameBytes);
+
+                start = micros();
+                canvas.fillScreen(1);
+                layout.drawLines(blitter, canvas, stream, lines.lines, lines.lineCount, 0);
+                blitElapsed += micros() - start;
+                allocations += allocationCount() - before;
+
+                // Both paths must produce the same pixels
+                TEST_ASSERT_EQUAL_MEMORY(reference.getBuffer(), canvas.getBuffer(), frameBytes);
+
+                bytes += lines.end - pos;
+                pos = layout.skipBlank(stream, lines.end);
+                pages++;
+            }
+
+            report("render", book, font, pages, bytes, gfxElapsed, 0);
+            report("blit", book, font, pages, bytes, blitElapsed, 0);
+            printf("%-9s %-12s %-15s %6.1f us/page gfx, %6.1f us/page blit, %5.1fx\n", "speedup", book.name.c_str(),
+                   font.name, (double)gfxElapsed / pages, (double)blitElapsed / pages,
+                   blitElapsed > 0 ? (double)gfxElapsed / blitElapsed : 0.0);
+            TEST_ASSERT_EQUAL_UINT32(0, allocations);
+        }
+    }
+}
+
+// A page turn before cached line tables (re-layout, then GFX text) against
+// cached lines laid out ahead by the prefetch, drawn with GFX text and with
+// the glyph blitter the reader uses now
+void test_page_turn()
+{
+    GFXcanvas1 canvas(PAGE_WIDTH, PAGE_HEIGHT);
+    PageLines lines;
+    PageLineCache cache;
+
+    for (const BenchBook &book : s_books)
+    {
+        for (const BenchFont &font : s_fonts)
+        {
+            TextLayout layout;
+            configureLayout(layout, font);
+            BookStream stream;
+            TEST_ASSERT_TRUE(stream.open(book.path));
+
+            canvas.setFont(&font.font);
+            canvas.setTextColor(0);
+            canvas.setTextWrap(false);
+            GlyphBlitter blitter;
+            TEST_ASSERT_TRUE(blitter.setFont(&font.font));
+            cache.clear();
+
+            unsigned long beforeElapsed = 0;
+            unsigned long cachedElapsed = 0;
+            unsigned long afterElapsed = 0;
+            uint32_t beforeAllocations = 0;
+            uint32_t afterAllocations = 0;
+            int pages = 0;
+            uint32_t pos = layout.skipBlank(stream, 0);
+            while (pos < stream.size() && pages < RENDER_PAGES)
+            {
+                uint32_t allocations = allocationCount();
+                unsigned long start = micros();
+                lines.end = layout.layoutPage(stream, pos, lines.lines, lines.lineCount);
+                canvas.fillScreen(1);
+                layout.drawLines(canvas, stream, lines.lines, lines.lineCount);
+                beforeElapsed += micros() - start;
+                beforeAllocations += allocationCount() - allocations;
+
+                // The prefetch lays the page out while the previous one is shown
+                PageLines &slot = cache.slotFor(pos);
+                slot.end = layout.layoutPage(stream, pos, slot.lines, slot.lineCount);
+
+                allocations = allocationCount();
+                start = micros();
+                const PageLines *page = cache.find(pos);
+                TEST_ASSERT_NOT_NULL(page);
+                canvas.fillScreen(1);
+                layout.drawLines(canvas, stream, page->lines, page->lineCount);
+                cachedElapsed += micros() - start;
+
+                start = micros();
+                canvas.fillScreen(1);
+                layout.drawLines(blitter, canvas, stream, page->lines, page->lineCount, 0);
+                afterElapsed += micros() - start;
+                afterAllocations += allocationCount() - allocations;
+
+                pos = layout.skipBlank(stream, page->end);
+                pages++;
+            }
+
+            printf("%-9s %-12s %-15s %6.1f us/turn before, %6.1f cached, %6.1f cached+blit, %.3f -> %.3f allocs/turn\n",
+                   "turn", book.name.c_str(), font.name, (double)beforeElapsed / pages, (double)cachedElapsed / pages,
+                   (double)afterElapsed / pages,
+                   (double)beforeAllocations / pages, (double)afterAllocations / pages);
+            TEST_ASSERT_EQUAL_UINT32(0, afterAllocations);
+        }
+    }
+}
+
+void test_paginate()
+{
+    for (const BenchBook &book : s_books)
+    {
+        for (const BenchFont &font : s_fonts)
+        {
+            TextLayout layout;
+            configureLayout(layout, font);
+            PageIndexKey key = {book.path, (uint32_t)book.size, 0, PageIndex::fontSignature(&font.font),
+                                (uint16_t)MARGIN, font.lineHeight, (uint16_t)PAGE_WIDTH, (uint16_t)PAGE_HEIGHT};
+
+            // The background task as the reader runs it, including its yields
+            Paginator paginator;
+            uint32_t allocations = allocationCount();
+            unsigned long start = micros();
+            TEST_ASSERT_TRUE(paginator.start(book.path, layout, key));
+            paginator.wait();
+            unsigned long elapsed = micros() - start;
+            allocations = allocationCount() - allocations;
+
+            TEST_ASSERT_TRUE(paginator.isComplete());
+            report("paginate", book, font, paginator.pageCount(), book.size, elapsed, allocations);
+
+            // The task must find exactly the pages the reader lays out
+            BookStream stream;
+            TEST_ASSERT_TRUE(stream.open(book.path));
+            TEST_ASSERT_EQUAL(layoutBook(stream, layout), paginator.pageCount());
+
+            // The index saved on completion loads back to the same pages
+            PageTable loaded;
+            start = micros();
+            TEST_ASSERT_TRUE(PageIndex::load(key, loaded));
+            elapsed = micros() - start;
+            TEST_ASSERT_EQUAL(paginator.pageCount(), (int)loaded.size());
+            for (size_t i = 0; i < loaded.size(); i++)
+            {
+                PageSpan span;
+                TEST_ASSERT_TRUE(paginator.getPage(i, span));
+                TEST_ASSERT_EQUAL_UINT32(span.offset, loaded[i].offset);
+                TEST_ASSERT_EQUAL_UINT32(span.length, loaded[i].length);
+            }
+            report("index", book, font, loaded.size(), loaded.size() * sizeof(PageSpan), elapsed, 0);
+        }
+    }
+}
+
+// Pages of a finished pagination, copied out of the task
+static void paginatedPages(const Paginator &paginator, std::vector<PageSpan> &pages)
+{
+    pages.resize(paginator.pageCount());
+    for (size_t i = 0; i < pages.size(); i++)
+    {
+        TEST_ASSERT_TRUE(paginator.getPage(i, pages[i]));
+    }
+}
+
+void test_paginate_anchor()
+{
+    const BenchBook &book = s_books[0];
+    const BenchFont &font = s_fonts[0];
+    TextLayout layout;
+    configureLayout(layout, font);
+    PageIndexKey key = {book.path, (uint32_t)book.size, 0, PageIndex::fontSignature(&font.font),
+                        (uint16_t)MARGIN, font.lineHeight, (uint16_t)PAGE_WIDTH, (uint16_t)PAGE_HEIGHT};
+    PageIndex::remove(key);
+
+    Paginator paginator;
+    TEST_ASSERT_TRUE(paginator.start(book.path, layout, key));
+    paginator.wait();
+    TEST_ASSERT_TRUE(paginator.isComplete());
+    std::vector<PageSpan> unanchored;
+    paginatedPages(paginator, unanchored);
+    TEST_ASSERT_TRUE(unanchored.size() > 20);
+
+    // Halfway into a page, as after a font change mid-book
+    uint32_t anchor = unanchored[10].offset + unanchored[10].length / 2;
+
+    // An anchored run starts a page at the anchor but leaves the saved index alone
+    Paginator anchored;
+    TEST_ASSERT_TRUE(anchored.start(book.path, layout, key, anchor));
+    anchored.wait();
+    TEST_ASSERT_TRUE(anchored.isComplete());
+    PageSpan span;
+    TEST_ASSERT_TRUE(anchored.getPage(anchored.findPage(anchor), span));
+    TEST_ASSERT_EQUAL_UINT32(anchor, span.offset);
+
+    PageTable loaded;
+    TEST_ASSERT_TRUE(PageIndex::load(key, loaded));
+    TEST_ASSERT_EQUAL(unanchored.size(), loaded.size());
+    for (size_t i = 0; i < loaded.size(); i++)
+    {
+        TEST_ASSERT_EQUAL_UINT32(unanchored[i].offset, loaded[i].offset);
+        TEST_ASSERT_EQUAL_UINT32(unanchored[i].length, loaded[i].length);
+    }
+
+    // Nor does it write one when there is none yet
+    PageIndex::remove(key);
+    Paginator first;
+    TEST_ASSERT_TRUE(first.start(book.path, layout, key, anchor));
+    first.wait();
+    TEST_ASSERT_TRUE(first.isComplete());
+    TEST_ASSERT_TRUE(!PageIndex::load(key, loaded));
+}
+
+void test_paginate_missing()
+{
+    // A book that cannot be opened ends the run as failed, not as pending
+    TextLayout layout;
+    configureLayout(layout, s_fonts[0]);
+    PageIndexKey key = {"/books/missing.txt", 0, 0, 0, 0, 0, 0, 0};
+    Paginator paginator;
+    TEST_ASSERT_TRUE(paginator.start(key.path, layout, key));
+    paginator.wait();
+    TEST_ASSERT_TRUE(paginator.hasFailed());
+    TEST_ASSERT_TRUE(!paginator.isComplete());
+    TEST_ASSERT_EQUAL(0, paginator.pageCount());
+}
+
+static void prepareCorpus()
+{
+    stdfs::path root = stdfs::temp_directory_path() / "reader_bench";
+    stdfs::remove_all(root);
+    stdfs::create_directories(root / "books");
+    SD.setRoot(root.string());
+
+    addBook(root, "prose.txt", makeProse(1024 * 1024));
+    addBook(root, "verse.txt", makeVerse(256 * 1024));
+    addBook(root, "dense.txt", makeDense(512 * 1024));
+
+    const char *corpus = getenv("READER_BENCH_CORPUS");
+    if (corpus && stdfs::is_directory(corpus))
+    {
+        for (const stdfs::directory_entry &entry : stdfs::directory_iterator(corpus))
+        {
+            if (entry.path().extension() == ".txt")
+            {
+                std::string name = entry.path().filename().string();
+                stdfs::copy_file(entry.path(), root / "books" / name, stdfs::copy_options::overwrite_existing);
+                s_books.push_back({name, String(("/books/" + name).c_str()), (size_t)stdfs::file_size(entry.path())});
+            }
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    for (BenchFont &font : s_fonts)
+    {
+        buildFont(font);
+    }
+    prepareCorpus();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_layout);
+    RUN_TEST(test_render);
+    RUN_TEST(test_page_turn);
+    RUN_TEST(test_paginate);
+    RUN_TEST(test_paginate_anchor);
+    RUN_TEST(test_paginate_missing);
+    return UNITY_END();
+}